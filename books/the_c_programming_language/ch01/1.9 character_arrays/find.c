@@ -0,0 +1,327 @@
+/*
+Program: Find - Print Lines Containing a Pattern
+Author: Greg Tate
+Date: 2026-10-19
+Context: The C Programming Language, Chapter 1.9 / 4.1 - the "find" program, built on the line reader from print_longest_line.c
+Purpose: Reads input in large blocks of whole lines and prints the lines that contain any of the patterns.
+         Candidates are found 16 bytes at a time by comparing the first and last byte of the pattern,
+         then confirmed with memcmp. Lines with no candidate are never looked at one character at a time;
+         they are skipped (or, with -v, written out) in bulk.
+Usage:   find [-i] [-v] [-n] [-c] [-e pattern]... [pattern] < input
+         -i  ignore ASCII case
+         -v  print lines that do not match
+         -n  prefix each line with its line number
+         -c  print only the number of selected lines
+Build:   gcc -O2 -std=c17 find.c -o find
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define BLOCKSIZE (1 << 20)     // Minimum amount read per refill
+#define MAXPATTERNS 64          // Patterns accepted on the command line
+
+struct pattern {
+    const char *text;           // Pattern bytes, lower-cased when -i is given
+    size_t len;
+    unsigned char first[2];     // First byte in lower and upper case (equal without -i)
+    unsigned char last[2];      // Last byte in lower and upper case
+    size_t next;                // Cached position of the next match in the current block
+};
+
+static struct pattern patterns[MAXPATTERNS];
+static int npatterns;
+static int ignore_case, invert, number, count_only;
+static unsigned long long lineno, nselected;
+
+size_t next_match(struct pattern *pat, const char *buf, size_t from, size_t end);
+int same_bytes(const char *s, const char *pat, size_t n);
+size_t count_newlines(const char *s, size_t n);
+void emit_lines(const char *s, size_t n);
+void process_block(const char *buf, size_t end);
+unsigned char to_lower(unsigned char c);
+
+int main(int argc, char *argv[])
+{
+    char *buf;
+    size_t cap = 2 * BLOCKSIZE, len = 0;
+    int eof = 0;
+
+    // Parse options; a bare argument is taken as a pattern
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "-e") == 0 && i + 1 < argc) {
+            arg = argv[++i];
+        } else if (arg[0] == '-' && arg[1] != '\0') {
+            for (const char *f = arg + 1; *f != '\0'; f++) {
+                if (*f == 'i') {
+                    ignore_case = 1;
+                } else if (*f == 'v') {
+                    invert = 1;
+                } else if (*f == 'n') {
+                    number = 1;
+                } else if (*f == 'c') {
+                    count_only = 1;
+                } else {
+                    fprintf(stderr, "usage: %s [-i] [-v] [-n] [-c] [-e pattern]... [pattern]\n", argv[0]);
+                    return 2;
+                }
+            }
+            continue;
+        }
+        if (npatterns == MAXPATTERNS) {
+            fprintf(stderr, "find: too many patterns\n");
+            return 2;
+        }
+        patterns[npatterns++].text = arg;
+    }
+    if (npatterns == 0) {
+        fprintf(stderr, "usage: %s [-i] [-v] [-n] [-c] [-e pattern]... [pattern]\n", argv[0]);
+        return 2;
+    }
+
+    // Precompute the first/last byte filters for each pattern
+    for (int i = 0; i < npatterns; i++) {
+        struct pattern *p = &patterns[i];
+        p->len = strlen(p->text);
+        if (ignore_case) {
+            char *lower = malloc(p->len + 1);
+            if (lower == NULL) {
+                fprintf(stderr, "find: out of memory\n");
+                return 2;
+            }
+            for (size_t j = 0; j <= p->len; j++) {
+                lower[j] = (char)to_lower((unsigned char)p->text[j]);
+            }
+            p->text = lower;
+        }
+        if (p->len > 0) {
+            unsigned char f = (unsigned char)p->text[0], l = (unsigned char)p->text[p->len - 1];
+            p->first[0] = p->first[1] = f;
+            p->last[0] = p->last[1] = l;
+            if (ignore_case && f >= 'a' && f <= 'z') {
+                p->first[1] = f - 'a' + 'A';
+            }
+            if (ignore_case && l >= 'a' && l <= 'z') {
+                p->last[1] = l - 'a' + 'A';
+            }
+        }
+    }
+
+    buf = malloc(cap + 1);
+    if (buf == NULL) {
+        fprintf(stderr, "find: out of memory\n");
+        return 2;
+    }
+    static char outbuf[1 << 16];
+    setvbuf(stdout, outbuf, _IOFBF, sizeof outbuf);
+
+    // Process the input a block of whole lines at a time, carrying any partial line forward
+    while (!eof || len > 0) {
+        size_t end = 0;
+
+        // Read until the buffer holds at least one complete line, growing it for very long lines
+        while (!eof) {
+            if (cap - len < BLOCKSIZE) {
+                cap *= 2;
+                buf = realloc(buf, cap + 1);
+                if (buf == NULL) {
+                    fprintf(stderr, "find: out of memory\n");
+                    return 2;
+                }
+            }
+            size_t got = fread(buf + len, 1, cap - len, stdin);
+            if (got == 0) {
+                eof = 1;
+                break;
+            }
+            const char *nl = memchr(buf + len, '\n', got);
+            len += got;
+            if (nl != NULL) {
+                break;
+            }
+        }
+
+        // Treat a last line without a newline as if it had one
+        if (eof && len > 0 && buf[len - 1] != '\n') {
+            buf[len++] = '\n';
+        }
+        for (end = len; end > 0 && buf[end - 1] != '\n'; end--) {
+        }
+        process_block(buf, end);
+        memmove(buf, buf + end, len - end);
+        len -= end;
+    }
+
+    if (count_only) {
+        printf("%llu\n", nselected);
+    }
+    fflush(stdout);
+    return nselected > 0 ? 0 : 1;
+}
+
+void process_block(const char *buf, size_t end)
+{
+    size_t p = 0;
+
+    // Match positions from an earlier block are meaningless here
+    for (int i = 0; i < npatterns; i++) {
+        patterns[i].next = 0;
+    }
+
+    while (p < end) {
+        size_t q = end;
+
+        // Earliest match among all patterns; each pattern only rescans once its cached match is passed
+        for (int i = 0; i < npatterns; i++) {
+            struct pattern *pat = &patterns[i];
+            if (pat->next < p || pat->next == 0) {
+                pat->next = next_match(pat, buf, p, end);
+            }
+            if (pat->next < q) {
+                q = pat->next;
+            }
+        }
+
+        // No more candidates: the rest of the block is non-matching lines, handled in bulk
+        if (q == end) {
+            if (invert) {
+                emit_lines(buf + p, end - p);
+            } else if (number) {
+                lineno += count_newlines(buf + p, end - p);
+            }
+            return;
+        }
+
+        // Widen the match to its whole line
+        size_t ls = q, le;
+        while (ls > p && buf[ls - 1] != '\n') {
+            ls--;
+        }
+        le = (size_t)((const char *)memchr(buf + q, '\n', end - q) - buf) + 1;
+
+        // Lines between here and the match did not match
+        if (invert) {
+            emit_lines(buf + p, ls - p);
+        } else if (number) {
+            lineno += count_newlines(buf + p, ls - p);
+        }
+        if (!invert) {
+            emit_lines(buf + ls, le - ls);
+        } else {
+            lineno++;
+        }
+        p = le;
+    }
+}
+
+size_t next_match(struct pattern *pat, const char *buf, size_t from, size_t end)
+{
+    size_t m = pat->len;
+    size_t i = from;
+
+    // An empty pattern matches at once
+    if (m == 0) {
+        return from;
+    }
+
+#ifdef __SSE2__
+    // Compare 16 first bytes and 16 last bytes at once; only positions where both agree are verified
+    const __m128i f0 = _mm_set1_epi8((char)pat->first[0]), f1 = _mm_set1_epi8((char)pat->first[1]);
+    const __m128i l0 = _mm_set1_epi8((char)pat->last[0]), l1 = _mm_set1_epi8((char)pat->last[1]);
+    while (i + m - 1 + 16 <= end) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(buf + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(buf + i + m - 1));
+        __m128i fa = _mm_or_si128(_mm_cmpeq_epi8(a, f0), _mm_cmpeq_epi8(a, f1));
+        __m128i lb = _mm_or_si128(_mm_cmpeq_epi8(b, l0), _mm_cmpeq_epi8(b, l1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(fa, lb));
+        while (mask != 0) {
+            unsigned bit = (unsigned)__builtin_ctz(mask);
+            if (m <= 2 || same_bytes(buf + i + bit + 1, pat->text + 1, m - 2)) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+        i += 16;
+    }
+#endif
+
+    // Tail of the block (or the whole block without SSE2)
+    for (; i + m <= end; i++) {
+        unsigned char c = (unsigned char)buf[i];
+        if ((c == pat->first[0] || c == pat->first[1]) && same_bytes(buf + i, pat->text, m)) {
+            return i;
+        }
+    }
+    return end;
+}
+
+int same_bytes(const char *s, const char *pat, size_t n)
+{
+    // Exact compare is memcmp; the -i compare folds only the input side (pattern is pre-lowered)
+    if (!ignore_case) {
+        return memcmp(s, pat, n) == 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (to_lower((unsigned char)s[i]) != (unsigned char)pat[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+size_t count_newlines(const char *s, size_t n)
+{
+    size_t count = 0, i = 0;
+
+#ifdef __SSE2__
+    // Count newlines 16 bytes at a time
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        count += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+    }
+#endif
+    for (; i < n; i++) {
+        count += s[i] == '\n';
+    }
+    return count;
+}
+
+void emit_lines(const char *s, size_t n)
+{
+    // Without -n or -c the lines go out in one write
+    if (n == 0) {
+        return;
+    }
+    if (!number || count_only) {
+        size_t lines = count_newlines(s, n);
+        nselected += lines;
+        lineno += lines;
+        if (!count_only) {
+            fwrite(s, 1, n, stdout);
+        }
+        return;
+    }
+
+    // With -n each line needs its own prefix
+    while (n > 0) {
+        const char *nl = memchr(s, '\n', n);
+        size_t len = (size_t)(nl - s) + 1;
+        printf("%llu:", ++lineno);
+        fwrite(s, 1, len, stdout);
+        nselected++;
+        s += len;
+        n -= len;
+    }
+}
+
+unsigned char to_lower(unsigned char c)
+{
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
@@ -0,0 +1,601 @@
+/*
+Program: Line Store - Sort, Unique, and Count Duplicate Lines
+Author: Greg Tate
+Date: 2026-10-19
+Context: The C Programming Language, Chapter 1.9 - builds on the getline idea from print_longest_line.c
+Purpose: Reads lines into a monotonic arena (lines stored back to back, indexed by offset and length)
+         instead of one malloc per line, then sorts them in parallel, prints distinct lines, or counts
+         duplicates. When the arena passes the memory budget, the batch is sorted and spilled to a run
+         file on disk, and the runs are merged at the end. Runs are merged early into one whenever
+         another would pass the open file limit.
+Usage:   line_store [-s | -u | -c] [-m budget_mb] [-t threads] < input
+         -s  sort lines (default)
+         -u  print each distinct line once, sorted
+         -c  print each distinct line once, sorted, prefixed by its count
+Build:   gcc -O2 -std=c17 -pthread line_store.c -o line_store
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "../word_scan.h"
+
+#define BLOCKSIZE (1 << 16)         // Input read size
+#define DEFAULT_BUDGET_MB 256       // Arena plus index budget before spilling
+#define MAXTHREADS 64               // Upper bound on sort threads
+#define MAXRUNS 4096                // Upper bound on runs open at once
+#define SPAREFILES 8                // Descriptors kept free for stdio and the merge output
+#define MAXLENGTH UINT32_MAX        // Longest line the index can describe
+
+enum mode { SORT, UNIQUE, COUNT };
+
+// Index entry: a slice of the arena plus how many times it was seen
+struct line {
+    uint64_t offset;
+    uint64_t count;             // Duplicates never reach the arena, so this can pass 2^32 without a spill
+    uint32_t length;            // Lines of MAXLENGTH bytes or more are rejected
+};
+
+// Monotonic arena: lines are appended back to back and only released all at once
+struct arena {
+    char *base;
+    size_t used;
+    size_t cap;
+};
+
+// Buffered input so lines are located with memchr instead of per-character getchar
+struct reader {
+    FILE *fp;
+    char buf[BLOCKSIZE];
+    size_t pos;
+    size_t len;
+};
+
+// Open-addressing hash set over arena slices, used by -u and -c
+struct lineset {
+    uint32_t *slots;                // Index into lines[] plus one; zero means empty
+    size_t mask;
+    size_t used;
+};
+
+// Cursor over one spilled run during the final merge
+struct run {
+    FILE *fp;
+    char *text;
+    size_t cap;
+    uint32_t length;
+    uint64_t count;
+};
+
+struct sort_job {
+    struct line *lines;
+    struct line *tmp;
+    size_t lo, mid, hi;
+};
+
+static struct arena arena;
+static struct line *lines;
+static size_t nlines, lines_cap;
+static struct lineset set;
+static struct run runs[MAXRUNS];
+static int nruns, max_runs;
+
+int arena_getline(struct reader *in, size_t *len);     // Appends next line to the arena
+int add_line(size_t start, size_t len, enum mode mode);
+int compare_lines(const struct line *a, const struct line *b);
+void sort_lines(struct line *v, size_t n, int nthreads);
+int open_run_limit(void);
+void spill_run(enum mode mode);
+void merge_runs(enum mode mode, FILE *out);
+void print_line(const char *s, size_t len, uint64_t count, enum mode mode);
+void reset_store(void);
+void die(const char *msg);
+
+int main(int argc, char *argv[])
+{
+    enum mode mode = SORT;
+    size_t budget = (size_t)DEFAULT_BUDGET_MB << 20;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int nthreads = ncpu > 0 ? (int)ncpu : 1;
+    static struct reader in;
+    size_t len;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0) {
+            mode = SORT;
+        } else if (strcmp(argv[i], "-u") == 0) {
+            mode = UNIQUE;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            mode = COUNT;
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            budget = (size_t)strtoul(argv[++i], NULL, 10) << 20;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            nthreads = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-s | -u | -c] [-m budget_mb] [-t threads]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+    if (nthreads > MAXTHREADS) {
+        nthreads = MAXTHREADS;
+    }
+    if (budget == 0) {
+        budget = 1 << 20;
+    }
+    max_runs = open_run_limit();
+
+    // Read every line into the arena, spilling a sorted run whenever the budget is passed
+    in.fp = stdin;
+    static char outbuf[1 << 20];
+    setvbuf(stdout, outbuf, _IOFBF, sizeof outbuf);
+    for (;;) {
+        size_t start = arena.used;
+        if (!arena_getline(&in, &len)) {
+            break;
+        }
+        if (len >= MAXLENGTH) {
+            die("line of 4 GiB or more");
+        }
+        add_line(start, len, mode);
+        if (arena.used + nlines * sizeof(struct line) > budget) {
+            sort_lines(lines, nlines, nthreads);
+            spill_run(mode);
+            reset_store();
+        }
+    }
+
+    // Everything fit in memory: sort and print straight from the arena
+    sort_lines(lines, nlines, nthreads);
+    if (nruns == 0) {
+        for (size_t i = 0; i < nlines; i++) {
+            const char *s = arena.base + lines[i].offset;
+            size_t n = lines[i].length;
+            uint64_t count = lines[i].count;
+
+            // Lines are only deduplicated by the hash set, so -s prints equal lines separately
+            while (i + 1 < nlines && mode != SORT && compare_lines(&lines[i], &lines[i + 1]) == 0) {
+                count += lines[++i].count;
+            }
+            print_line(s, n, count, mode);
+        }
+        return 0;
+    }
+
+    // Otherwise spill the last batch and merge all runs from disk
+    spill_run(mode);
+    reset_store();
+    merge_runs(mode, NULL);
+    return 0;
+}
+
+int arena_getline(struct reader *in, size_t *len)
+{
+    size_t start = arena.used;
+    int got = 0;
+
+    // Copy whole runs of bytes up to the next newline into the arena
+    for (;;) {
+        if (in->pos == in->len) {
+            in->len = fread(in->buf, 1, BLOCKSIZE, in->fp);
+            in->pos = 0;
+            if (in->len == 0) {
+                break;
+            }
+        }
+        got = 1;
+        char *p = in->buf + in->pos;
+        size_t avail = in->len - in->pos;
+        char *nl = memchr(p, '\n', avail);
+        size_t take = nl ? (size_t)(nl - p) : avail;
+
+        // Grow the arena geometrically; offsets stay valid across realloc
+        if (arena.used + take > arena.cap) {
+            size_t cap = arena.cap ? arena.cap : BLOCKSIZE;
+            while (cap < arena.used + take) {
+                cap *= 2;
+            }
+            arena.base = realloc(arena.base, cap);
+            if (arena.base == NULL) {
+                die("out of memory growing arena");
+            }
+            arena.cap = cap;
+        }
+        memcpy(arena.base + arena.used, p, take);
+        arena.used += take;
+        in->pos += take;
+        if (nl) {
+            in->pos++;              // Consume the newline but do not store it
+            break;
+        }
+    }
+    *len = arena.used - start;
+    return got;
+}
+
+int add_line(size_t start, size_t len, enum mode mode)
+{
+    // Grow the index when full
+    if (nlines == lines_cap) {
+        lines_cap = lines_cap ? lines_cap * 2 : 4096;
+        lines = realloc(lines, lines_cap * sizeof(struct line));
+        if (lines == NULL) {
+            die("out of memory growing index");
+        }
+    }
+    if (mode == SORT) {
+        lines[nlines++] = (struct line){start, 1, (uint32_t)len};
+        return 1;
+    }
+
+    // Keep the hash set at most half full
+    if ((set.used + 1) * 2 > set.mask + 1) {
+        size_t size = set.slots ? (set.mask + 1) * 2 : 4096;
+        uint32_t *slots = calloc(size, sizeof(uint32_t));
+        if (slots == NULL) {
+            die("out of memory growing hash set");
+        }
+        for (size_t i = 0; set.slots && i <= set.mask; i++) {
+            if (set.slots[i] == 0) {
+                continue;
+            }
+            struct line *l = &lines[set.slots[i] - 1];
+            size_t j = hash_bytes(arena.base + l->offset, l->length) & (size - 1);
+            while (slots[j] != 0) {
+                j = (j + 1) & (size - 1);
+            }
+            slots[j] = set.slots[i];
+        }
+        free(set.slots);
+        set.slots = slots;
+        set.mask = size - 1;
+    }
+
+    // Probe for an equal slice; a duplicate is rolled back off the end of the arena
+    const char *s = arena.base + start;
+    size_t j = hash_bytes(s, len) & set.mask;
+    while (set.slots[j] != 0) {
+        struct line *l = &lines[set.slots[j] - 1];
+        if (l->length == len && memcmp(arena.base + l->offset, s, len) == 0) {
+            l->count++;
+            arena.used = start;
+            return 0;
+        }
+        j = (j + 1) & set.mask;
+    }
+    lines[nlines++] = (struct line){start, 1, (uint32_t)len};
+    set.slots[j] = (uint32_t)nlines;
+    set.used++;
+    return 1;
+}
+
+int compare_lines(const struct line *a, const struct line *b)
+{
+    size_t n = a->length < b->length ? a->length : b->length;
+    int r = memcmp(arena.base + a->offset, arena.base + b->offset, n);
+
+    // Byte order, shorter line first on a common prefix
+    if (r != 0) {
+        return r;
+    }
+    return (a->length > b->length) - (a->length < b->length);
+}
+
+static int qsort_compare(const void *a, const void *b)
+{
+    return compare_lines(a, b);
+}
+
+static void *sort_slice(void *arg)
+{
+    struct sort_job *job = arg;
+    qsort(job->lines + job->lo, job->hi - job->lo, sizeof(struct line), qsort_compare);
+    return NULL;
+}
+
+static void *merge_slices(void *arg)
+{
+    struct sort_job *job = arg;
+    size_t i = job->lo, j = job->mid, k = job->lo;
+
+    // Standard two-way merge into the scratch buffer
+    while (i < job->mid && j < job->hi) {
+        if (compare_lines(&job->lines[j], &job->lines[i]) < 0) {
+            job->tmp[k++] = job->lines[j++];
+        } else {
+            job->tmp[k++] = job->lines[i++];
+        }
+    }
+    while (i < job->mid) {
+        job->tmp[k++] = job->lines[i++];
+    }
+    while (j < job->hi) {
+        job->tmp[k++] = job->lines[j++];
+    }
+    return NULL;
+}
+
+void sort_lines(struct line *v, size_t n, int nthreads)
+{
+    pthread_t tid[MAXTHREADS];
+    int started[MAXTHREADS];
+    struct sort_job jobs[MAXTHREADS];
+    size_t bounds[MAXTHREADS + 1];
+    int parts = nthreads;
+
+    // Small inputs are not worth the threads
+    if (n < 65536 || parts == 1) {
+        qsort(v, n, sizeof(struct line), qsort_compare);
+        return;
+    }
+
+    // Sort equal slices concurrently; a slice whose thread cannot be started is sorted here instead
+    for (int t = 0; t <= parts; t++) {
+        bounds[t] = n * (size_t)t / (size_t)parts;
+    }
+    for (int t = 0; t < parts; t++) {
+        jobs[t] = (struct sort_job){v, NULL, bounds[t], 0, bounds[t + 1]};
+        started[t] = pthread_create(&tid[t], NULL, sort_slice, &jobs[t]) == 0;
+        if (!started[t]) {
+            sort_slice(&jobs[t]);
+        }
+    }
+    for (int t = 0; t < parts; t++) {
+        if (started[t]) {
+            pthread_join(tid[t], NULL);
+        }
+    }
+
+    // Merge neighbouring slices pairwise, each pass in parallel, until one remains
+    struct line *tmp = malloc(n * sizeof(struct line));
+    if (tmp == NULL) {
+        die("out of memory sorting");
+    }
+    while (parts > 1) {
+        int pairs = parts / 2;
+        for (int p = 0; p < pairs; p++) {
+            jobs[p] = (struct sort_job){v, tmp, bounds[2 * p], bounds[2 * p + 1], bounds[2 * p + 2]};
+            started[p] = pthread_create(&tid[p], NULL, merge_slices, &jobs[p]) == 0;
+            if (!started[p]) {
+                merge_slices(&jobs[p]);
+            }
+        }
+        for (int p = 0; p < pairs; p++) {
+            if (started[p]) {
+                pthread_join(tid[p], NULL);
+            }
+        }
+        // An odd slice at the end is carried over unchanged
+        if (parts % 2 == 1) {
+            memcpy(tmp + bounds[parts - 1], v + bounds[parts - 1],
+                   (bounds[parts] - bounds[parts - 1]) * sizeof(struct line));
+        }
+        for (int p = 0; p <= pairs; p++) {
+            bounds[p] = bounds[2 * p < parts ? 2 * p : parts];
+        }
+        bounds[(parts + 1) / 2] = n;
+        parts = (parts + 1) / 2;
+        struct line *swap = v;
+        v = tmp;
+        tmp = swap;
+    }
+
+    // The result may have ended up in the scratch buffer
+    if (v != lines) {
+        memcpy(lines, v, n * sizeof(struct line));
+        tmp = v;
+    }
+    free(tmp);
+}
+
+int open_run_limit(void)
+{
+    struct rlimit rl;
+
+    // Every run holds a descriptor until the merge, so stay below the process limit
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY ||
+        rl.rlim_cur >= MAXRUNS + SPAREFILES) {
+        return MAXRUNS;
+    }
+    return rl.rlim_cur > SPAREFILES + 2 ? (int)(rl.rlim_cur - SPAREFILES) : 2;
+}
+
+static void write_record(FILE *fp, const char *s, uint32_t length, uint64_t count)
+{
+    // Each record is a 32-bit length, a 64-bit count, then the line bytes
+    fwrite(&length, sizeof(uint32_t), 1, fp);
+    fwrite(&count, sizeof(uint64_t), 1, fp);
+    fwrite(s, 1, length, fp);
+}
+
+static FILE *new_run(void)
+{
+    FILE *fp = tmpfile();
+
+    if (fp == NULL) {
+        die("cannot create run file");
+    }
+    return fp;
+}
+
+static void finish_run(FILE *fp)
+{
+    if (ferror(fp) || fflush(fp) != 0) {
+        die("write error on run file");
+    }
+    rewind(fp);
+    runs[nruns++].fp = fp;
+}
+
+void spill_run(enum mode mode)
+{
+    FILE *fp;
+
+    if (nlines == 0) {
+        return;
+    }
+
+    // At the open file limit, fold the runs so far into one before adding another
+    if (nruns == max_runs) {
+        fp = new_run();
+        merge_runs(mode, fp);
+        nruns = 0;
+        finish_run(fp);
+    }
+    fp = new_run();
+    for (size_t i = 0; i < nlines; i++) {
+        write_record(fp, arena.base + lines[i].offset, lines[i].length, lines[i].count);
+    }
+    finish_run(fp);
+}
+
+static int next_record(struct run *r)
+{
+    // Load the next record of a run; returns 0 when the run is exhausted
+    if (fread(&r->length, sizeof(uint32_t), 1, r->fp) != 1 ||
+        fread(&r->count, sizeof(uint64_t), 1, r->fp) != 1) {
+        return 0;
+    }
+    if (r->length > r->cap) {
+        r->cap = r->length;
+        r->text = realloc(r->text, r->cap);
+        if (r->text == NULL) {
+            die("out of memory reading run");
+        }
+    }
+    if (fread(r->text, 1, r->length, r->fp) != r->length) {
+        die("truncated run file");
+    }
+    return 1;
+}
+
+static int run_less(const struct run *a, const struct run *b)
+{
+    size_t n = a->length < b->length ? a->length : b->length;
+    int r = memcmp(a->text, b->text, n);
+    return r != 0 ? r < 0 : a->length < b->length;
+}
+
+static void sift_down(struct run **heap, int n, int i)
+{
+    // Restore the min-heap property below position i
+    for (;;) {
+        int least = i, l = 2 * i + 1, r = l + 1;
+        if (l < n && run_less(heap[l], heap[least])) {
+            least = l;
+        }
+        if (r < n && run_less(heap[r], heap[least])) {
+            least = r;
+        }
+        if (least == i) {
+            return;
+        }
+        struct run *swap = heap[i];
+        heap[i] = heap[least];
+        heap[least] = swap;
+        i = least;
+    }
+}
+
+static void put_record(FILE *out, const char *s, size_t len, uint64_t count, enum mode mode)
+{
+    // The final merge prints; an early merge writes a run for the next one
+    if (out == NULL) {
+        print_line(s, len, count, mode);
+    } else {
+        write_record(out, s, (uint32_t)len, count);
+    }
+}
+
+void merge_runs(enum mode mode, FILE *out)
+{
+    static struct run *heap[MAXRUNS];
+    int n = 0;
+    char *prev = NULL;
+    size_t prev_cap = 0, prev_len = 0;
+    uint64_t prev_count = 0;
+    int have_prev = 0;
+
+    // Prime the heap with the first record of every run
+    for (int i = 0; i < nruns; i++) {
+        if (next_record(&runs[i])) {
+            heap[n++] = &runs[i];
+        }
+    }
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        sift_down(heap, n, i);
+    }
+
+    // Pop the smallest record; -u and -c fold equal lines from different runs together
+    while (n > 0) {
+        struct run *r = heap[0];
+        if (mode == SORT) {
+            put_record(out, r->text, r->length, r->count, mode);
+        } else if (have_prev && prev_len == r->length && memcmp(prev, r->text, prev_len) == 0) {
+            prev_count += r->count;
+        } else {
+            if (have_prev) {
+                put_record(out, prev, prev_len, prev_count, mode);
+            }
+            if (r->length > prev_cap) {
+                prev_cap = r->length;
+                prev = realloc(prev, prev_cap);
+                if (prev == NULL) {
+                    die("out of memory merging runs");
+                }
+            }
+            memcpy(prev, r->text, r->length);
+            prev_len = r->length;
+            prev_count = r->count;
+            have_prev = 1;
+        }
+        if (!next_record(r)) {
+            fclose(r->fp);
+            heap[0] = heap[--n];
+        }
+        sift_down(heap, n, 0);
+    }
+    if (have_prev) {
+        put_record(out, prev, prev_len, prev_count, mode);
+    }
+    free(prev);
+}
+
+void print_line(const char *s, size_t len, uint64_t count, enum mode mode)
+{
+    // -s repeats the line once per occurrence, -c prefixes the count like uniq -c
+    if (mode == COUNT) {
+        printf("%7llu ", (unsigned long long)count);
+    }
+    for (uint64_t i = 0; i < (mode == SORT ? count : 1); i++) {
+        fwrite(s, 1, len, stdout);
+        putchar('\n');
+    }
+}
+
+void reset_store(void)
+{
+    // Release the whole batch at once; buffers are kept for the next batch
+    arena.used = 0;
+    nlines = 0;
+    if (set.slots) {
+        memset(set.slots, 0, (set.mask + 1) * sizeof(uint32_t));
+    }
+    set.used = 0;
+}
+
+void die(const char *msg)
+{
+    fprintf(stderr, "line_store: %s\n", msg);
+    exit(1);
+}
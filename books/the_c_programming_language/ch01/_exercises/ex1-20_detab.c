@@ -0,0 +1,160 @@
+/*
+ * Detab: Replace Tabs with the Proper Number of Blanks
+ *
+ * Exercise 1-20 from "The C Programming Language" by Kernighan and Ritchie
+ * Write a program detab that replaces tabs in the input with the proper number
+ * of blanks to space to the next tab stop. Assume a fixed set of tab stops,
+ * say every n columns.
+ *
+ * Instead of looking at one character at a time, tabs, backspaces and newlines
+ * are located 16 bytes at a time with SSE2, the text between them is copied in
+ * one piece, and the padding for each tab is computed from the column reached by
+ * that run. Every other byte counts as one column; as in expand(1), a backspace
+ * moves back one column, and the column resets at each newline.
+ * Output is collected in one large buffer and written in big pieces.
+ *
+ * Usage: detab [-t n] < input > output    (tab stops every n columns, default 8)
+ * Build: gcc -O2 -std=c17 ex1-20_detab.c -o detab
+ *
+ * Author: Greg Tate
+ * Date: 2026-10-19
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define TABSTOP 8               /* Default distance between tab stops */
+#define MAXTABSTOP 1024
+#define BLOCKSIZE (1 << 20)
+
+static char out[BLOCKSIZE + MAXTABSTOP];
+static size_t out_len;
+
+const char *find_control(const char *p, const char *end);
+void put_bytes(const char *s, size_t n);
+void put_blanks(size_t n);
+
+int main(int argc, char *argv[])
+{
+    static char in[BLOCKSIZE];
+    size_t tabstop = TABSTOP;
+    size_t col = 0;
+    size_t got;
+
+    /* Read the tab stop distance */
+    if (argc == 3 && strcmp(argv[1], "-t") == 0)
+    {
+        tabstop = (size_t)atoi(argv[2]);
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [-t n]\n", argv[0]);
+        return 2;
+    }
+    if (tabstop < 1 || tabstop > MAXTABSTOP)
+    {
+        fprintf(stderr, "detab: tab stop must be 1..%d\n", MAXTABSTOP);
+        return 2;
+    }
+
+    /* The column carries over from one block to the next */
+    while ((got = fread(in, 1, BLOCKSIZE, stdin)) > 0)
+    {
+        const char *p = in, *end = in + got;
+
+        while (p < end)
+        {
+            const char *hit = find_control(p, end);
+
+            /* Copy the run of ordinary text in one piece */
+            put_bytes(p, (size_t)(hit - p));
+            col += (size_t)(hit - p);
+            if (hit == end)
+            {
+                break;
+            }
+
+            /* Expand a tab to the next stop; a backspace steps back; a newline starts column zero */
+            if (*hit == '\t')
+            {
+                size_t pad = tabstop - col % tabstop;
+                put_blanks(pad);
+                col += pad;
+            }
+            else if (*hit == '\b')
+            {
+                put_bytes("\b", 1);
+                col -= col > 0;
+            }
+            else
+            {
+                put_bytes("\n", 1);
+                col = 0;
+            }
+            p = hit + 1;
+        }
+    }
+
+    fwrite(out, 1, out_len, stdout);
+    return ferror(stdin) || ferror(stdout);
+}
+
+const char *find_control(const char *p, const char *end)
+{
+#ifdef __SSE2__
+    /* Compare 16 bytes against tab, backspace and newline at once */
+    const __m128i tab = _mm_set1_epi8('\t'), bs = _mm_set1_epi8('\b'), nl = _mm_set1_epi8('\n');
+    for (; p + 16 <= end; p += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_or_si128(_mm_cmpeq_epi8(v, bs), _mm_cmpeq_epi8(v, nl)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; p < end; p++)
+    {
+        if (*p == '\t' || *p == '\b' || *p == '\n')
+        {
+            return p;
+        }
+    }
+    return end;
+}
+
+void put_bytes(const char *s, size_t n)
+{
+    /* Flush when the buffer would overflow; very long runs skip the buffer */
+    if (out_len + n > BLOCKSIZE)
+    {
+        fwrite(out, 1, out_len, stdout);
+        out_len = 0;
+        if (n > BLOCKSIZE)
+        {
+            fwrite(s, 1, n, stdout);
+            return;
+        }
+    }
+    memcpy(out + out_len, s, n);
+    out_len += n;
+}
+
+void put_blanks(size_t n)
+{
+    /* n is at most MAXTABSTOP, which the buffer always has room for past BLOCKSIZE */
+    memset(out + out_len, ' ', n);
+    out_len += n;
+    if (out_len > BLOCKSIZE)
+    {
+        fwrite(out, 1, out_len, stdout);
+        out_len = 0;
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * Entab: Replace Strings of Blanks with Tabs and Blanks
+ *
+ * Exercise 1-21 from "The C Programming Language" by Kernighan and Ritchie
+ * Write a program entab that replaces strings of blanks by the minimum number
+ * of tabs and blanks to achieve the same spacing. Use the same tab stops as
+ * for detab. When either a tab or a single blank would suffice to reach a tab
+ * stop, which should be given preference?
+ *
+ * Answer used here: the blank. A tab is written only when it covers two or more
+ * columns, so both choices have the same length and the output keeps single
+ * blanks between words as they were.
+ *
+ * Blanks, tabs, backspaces and newlines are located 16 bytes at a time with
+ * SSE2 and the text between them is copied in one piece. Each run of blanks and
+ * tabs is measured by the column it ends at and rewritten as tabs up to the last
+ * stop before that column, then blanks. Every other byte counts as one column;
+ * as in unexpand(1), a backspace moves back one column, and the column resets at
+ * each newline. Output is collected in one large buffer.
+ *
+ * Usage: entab [-t n] < input > output    (tab stops every n columns, default 8)
+ * Build: gcc -O2 -std=c17 ex1-21_entab.c -o entab
+ *
+ * Author: Greg Tate
+ * Date: 2026-10-19
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define TABSTOP 8               /* Default distance between tab stops */
+#define MAXTABSTOP 1024
+#define BLOCKSIZE (1 << 20)
+
+static char out[BLOCKSIZE];
+static size_t out_len;
+
+const char *find_space(const char *p, const char *end);
+size_t put_spacing(size_t col, size_t target, size_t tabstop);
+void put_bytes(const char *s, size_t n);
+void put_char(char c);
+
+int main(int argc, char *argv[])
+{
+    static char in[BLOCKSIZE];
+    size_t tabstop = TABSTOP;
+    size_t col = 0;             /* Column of the text written so far */
+    size_t target = 0;          /* Column a pending run of blanks and tabs reaches */
+    size_t got;
+
+    /* Read the tab stop distance */
+    if (argc == 3 && strcmp(argv[1], "-t") == 0)
+    {
+        tabstop = (size_t)atoi(argv[2]);
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [-t n]\n", argv[0]);
+        return 2;
+    }
+    if (tabstop < 1 || tabstop > MAXTABSTOP)
+    {
+        fprintf(stderr, "entab: tab stop must be 1..%d\n", MAXTABSTOP);
+        return 2;
+    }
+
+    /* A run of blanks may continue into the next block, so it is kept as a pending target column */
+    while ((got = fread(in, 1, BLOCKSIZE, stdin)) > 0)
+    {
+        const char *p = in, *end = in + got;
+
+        while (p < end)
+        {
+            /* Measure blanks and tabs without writing anything yet */
+            while (p < end && (*p == ' ' || *p == '\t'))
+            {
+                target = *p == ' ' ? target + 1 : (target / tabstop + 1) * tabstop;
+                p++;
+            }
+            if (p == end)
+            {
+                break;
+            }
+
+            /* The run is over: fill from col to target with tabs, then blanks */
+            col = put_spacing(col, target, tabstop);
+
+            /* Copy ordinary text up to the next blank, tab, backspace or newline in one piece */
+            const char *hit = find_space(p, end);
+            put_bytes(p, (size_t)(hit - p));
+            col += (size_t)(hit - p);
+            p = hit;
+            if (p < end && *p == '\n')
+            {
+                put_char('\n');
+                col = 0;
+                p++;
+            }
+            else if (p < end && *p == '\b')
+            {
+                put_char('\b');
+                col -= col > 0;
+                p++;
+            }
+            target = col;
+        }
+    }
+
+    /* Blanks left at the very end are written as they would be before any text */
+    put_spacing(col, target, tabstop);
+
+    fwrite(out, 1, out_len, stdout);
+    return ferror(stdin) || ferror(stdout);
+}
+
+const char *find_space(const char *p, const char *end)
+{
+#ifdef __SSE2__
+    /* Compare 16 bytes against blank, tab, backspace and newline at once */
+    const __m128i blank = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'), bs = _mm_set1_epi8('\b');
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; p + 16 <= end; p += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, blank), _mm_cmpeq_epi8(v, tab)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, bs), _mm_cmpeq_epi8(v, nl)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; p < end; p++)
+    {
+        if (*p == ' ' || *p == '\t' || *p == '\b' || *p == '\n')
+        {
+            return p;
+        }
+    }
+    return end;
+}
+
+size_t put_spacing(size_t col, size_t target, size_t tabstop)
+{
+    /* Tabs while the next stop is within reach and at least two columns away, then blanks */
+    while (col < target)
+    {
+        size_t stop = (col / tabstop + 1) * tabstop;
+        if (stop <= target && stop - col >= 2)
+        {
+            put_char('\t');
+            col = stop;
+        }
+        else
+        {
+            put_char(' ');
+            col++;
+        }
+    }
+    return col;
+}
+
+void put_bytes(const char *s, size_t n)
+{
+    /* Flush when the buffer would overflow; very long runs skip the buffer */
+    if (out_len + n > BLOCKSIZE)
+    {
+        fwrite(out, 1, out_len, stdout);
+        out_len = 0;
+        if (n > BLOCKSIZE)
+        {
+            fwrite(s, 1, n, stdout);
+            return;
+        }
+    }
+    memcpy(out + out_len, s, n);
+    out_len += n;
+}
+
+void put_char(char c)
+{
+    if (out_len == BLOCKSIZE)
+    {
+        fwrite(out, 1, out_len, stdout);
+        out_len = 0;
+    }
+    out[out_len++] = c;
+}
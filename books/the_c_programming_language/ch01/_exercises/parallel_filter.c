@@ -0,0 +1,343 @@
+/*
+ * Parallel Order-Preserving Filters
+ *
+ * Runs the chapter 1 copy-and-transform exercises across all cores:
+ *   squeeze  ex1_9_squeeze_blanks.c - each run of blanks becomes one blank
+ *   escape   ex1-10.c - tab, backspace and backslash become \t, \b and \\
+ *   words    echo_input.c (exercise 1-12) - one word per line
+ * Input is cut into chunks that worker threads transform at the same time, each into its own
+ * output buffer. The writer takes the buffers strictly in input order, fixing up the state that
+ * crosses a chunk boundary (a blank run that spans two chunks in squeeze), so the output is byte
+ * for byte what the serial program prints. At most 2 * threads + 1 chunks are in flight, which bounds memory
+ * no matter how large the input is. With KR_METRICS=name set, each worker publishes the bytes it has
+ * transformed to its own slot after every chunk, for metrics_view.c (see live_metrics.h).
+ *
+ * Usage: parallel_filter squeeze|escape|words [-j threads] < input > output
+ * Build: gcc -O2 -std=c17 -pthread parallel_filter.c -o parallel_filter
+ *
+ * Author: Greg Tate
+ * Date: 2026-10-19
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../live_metrics.h"
+
+#define CHUNKSIZE (1 << 20)     /* Input bytes per chunk */
+#define MAXTHREADS 64
+
+enum slot_state { FREE, BUSY, DONE };
+
+/* One chunk in flight: its input, its transformed output, and what the writer needs at the seam */
+struct slot {
+    enum slot_state state;
+    long seq;
+    char *in;
+    size_t in_len;
+    char *out;
+    size_t out_len;
+    int ends_blank;             /* squeeze: chunk ended inside a run of blanks it did not print */
+};
+
+/* A filter transforms one chunk as if it were the whole input and reports its boundary state */
+struct filter {
+    const char *name;
+    size_t expansion;           /* Worst-case output bytes per input byte */
+    void (*run)(struct slot *s);
+};
+
+static struct slot *slots;
+static int window;
+static long next_read;
+static int at_eof;
+static const struct filter *filter;
+static struct metrics *metrics;
+static pthread_mutex_t read_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slot_freed = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t slot_done = PTHREAD_COND_INITIALIZER;
+
+void squeeze(struct slot *s);
+void escape(struct slot *s);
+void words(struct slot *s);
+void *worker(void *arg);
+
+static const struct filter filters[] = {
+    {"squeeze", 1, squeeze},
+    {"escape", 2, escape},
+    {"words", 2, words},
+};
+
+int main(int argc, char *argv[])
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int nthreads = ncpu > 0 ? (int)ncpu : 1;
+    pthread_t tid[MAXTHREADS];
+    static unsigned slot_of[MAXTHREADS];
+    const char *labels[] = {"chunks", "out bytes", NULL};
+    int started = 0;
+    int carry_blank = 0;
+    int bad = 0;
+
+    /* Pick the filter and thread count; anything else, or a second filter, is a usage error */
+    for (int i = 1; i < argc && !bad; i++)
+    {
+        const struct filter *named = NULL;
+
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            nthreads = atoi(argv[++i]);
+            continue;
+        }
+        for (size_t f = 0; f < sizeof filters / sizeof filters[0]; f++)
+        {
+            if (strcmp(argv[i], filters[f].name) == 0)
+            {
+                named = &filters[f];
+            }
+        }
+        bad = named == NULL || filter != NULL;
+        filter = named;
+    }
+    if (bad || filter == NULL)
+    {
+        fprintf(stderr, "usage: %s squeeze|escape|words [-j threads]\n", argv[0]);
+        return 2;
+    }
+    if (nthreads < 1)
+    {
+        nthreads = 1;
+    }
+    if (nthreads > MAXTHREADS)
+    {
+        nthreads = MAXTHREADS;
+    }
+
+    /* Two chunks per worker keeps everyone busy while the writer drains the oldest */
+    window = 2 * nthreads + 1;
+    slots = calloc((size_t)window, sizeof *slots);
+    if (slots == NULL)
+    {
+        fprintf(stderr, "parallel_filter: out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < window; i++)
+    {
+        slots[i].in = malloc(CHUNKSIZE);
+        slots[i].out = malloc(CHUNKSIZE * filter->expansion);
+        slots[i].state = FREE;
+        if (slots[i].in == NULL || slots[i].out == NULL)
+        {
+            fprintf(stderr, "parallel_filter: out of memory\n");
+            return 1;
+        }
+    }
+
+    /* Fewer workers only narrow the parallelism; with none the chunks would never be read */
+    metrics = metrics_open("parallel_filter", (unsigned)nthreads, labels);
+    for (int t = 0; t < nthreads; t++)
+    {
+        slot_of[started] = (unsigned)started;
+        if (pthread_create(&tid[started], NULL, worker, &slot_of[started]) == 0)
+        {
+            started++;
+        }
+    }
+    if (started == 0)
+    {
+        fprintf(stderr, "parallel_filter: cannot start worker threads\n");
+        return 1;
+    }
+
+    /* Write chunks in input order; an empty chunk marks the end */
+    for (long seq = 0;; seq++)
+    {
+        struct slot *s = &slots[seq % window];
+
+        pthread_mutex_lock(&lock);
+        while (s->state != DONE || s->seq != seq)
+        {
+            pthread_cond_wait(&slot_done, &lock);
+        }
+        pthread_mutex_unlock(&lock);
+        if (s->in_len == 0)
+        {
+            break;
+        }
+
+        /* A blank run left open by the previous chunk is printed once, before the next non-blank */
+        if (filter->run == squeeze)
+        {
+            if (carry_blank && s->in[0] != ' ')
+            {
+                putchar(' ');
+            }
+            carry_blank = s->ends_blank;
+        }
+        fwrite(s->out, 1, s->out_len, stdout);
+
+        pthread_mutex_lock(&lock);
+        s->state = FREE;
+        pthread_cond_broadcast(&slot_freed);
+        pthread_mutex_unlock(&lock);
+    }
+
+    for (int t = 0; t < started; t++)
+    {
+        pthread_join(tid[t], NULL);
+    }
+    metrics_close(metrics);
+    fflush(stdout);
+    return ferror(stdin) || ferror(stdout);
+}
+
+void *worker(void *arg)
+{
+    unsigned slot = *(const unsigned *)arg;        /* This worker's metrics slot */
+    uint64_t done = 0, counters[METRICS_COUNTERS] = {0};
+
+    for (;;)
+    {
+        struct slot *s;
+        long seq;
+
+        /* Reads happen one at a time so chunk numbers follow the input */
+        pthread_mutex_lock(&read_lock);
+        if (at_eof)
+        {
+            pthread_mutex_unlock(&read_lock);
+            return NULL;
+        }
+        seq = next_read++;
+        s = &slots[seq % window];
+        pthread_mutex_lock(&lock);
+        while (s->state != FREE)
+        {
+            pthread_cond_wait(&slot_freed, &lock);
+        }
+        s->state = BUSY;
+        pthread_mutex_unlock(&lock);
+        s->in_len = fread(s->in, 1, CHUNKSIZE, stdin);
+        if (s->in_len == 0)
+        {
+            at_eof = 1;
+        }
+        pthread_mutex_unlock(&read_lock);
+
+        /* Transform outside every lock */
+        s->out_len = 0;
+        s->ends_blank = 0;
+        if (s->in_len > 0)
+        {
+            filter->run(s);
+            done += s->in_len;
+            counters[0]++;
+            counters[1] += s->out_len;
+            metrics_publish(metrics, slot, done, counters);
+        }
+
+        pthread_mutex_lock(&lock);
+        s->seq = seq;
+        s->state = DONE;
+        pthread_cond_broadcast(&slot_done);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+void squeeze(struct slot *s)
+{
+    const char *in = s->in, *end = s->in + s->in_len;
+    char *out = s->out;
+    int blanks = 0;
+
+    /* Same rule as ex1_9_squeeze_blanks.c: a blank run is printed as one blank before the next non-blank */
+    while (in < end)
+    {
+        const char *blank = memchr(in, ' ', (size_t)(end - in));
+        size_t run = (size_t)((blank ? blank : end) - in);
+
+        if (run > 0)
+        {
+            if (blanks > 0)
+            {
+                *out++ = ' ';
+            }
+            memcpy(out, in, run);
+            out += run;
+            in += run;
+            blanks = 0;
+        }
+        while (in < end && *in == ' ')
+        {
+            blanks++;
+            in++;
+        }
+    }
+    s->out_len = (size_t)(out - s->out);
+    s->ends_blank = blanks > 0;
+}
+
+void escape(struct slot *s)
+{
+    const char *in = s->in;
+    char *out = s->out;
+
+    /* Same replacements as ex1-10.c; every other character is copied */
+    for (size_t i = 0; i < s->in_len; i++)
+    {
+        char c = in[i];
+        if (c == '\t')
+        {
+            *out++ = '\\';
+            *out++ = 't';
+        }
+        else if (c == '\b')
+        {
+            *out++ = '\\';
+            *out++ = 'b';
+        }
+        else if (c == '\\')
+        {
+            *out++ = '\\';
+            *out++ = '\\';
+        }
+        else
+        {
+            *out++ = c;
+        }
+    }
+    s->out_len = (size_t)(out - s->out);
+}
+
+void words(struct slot *s)
+{
+    const char *in = s->in;
+    char *out = s->out;
+
+    /* Same rules as echo_input.c: punctuation starts a new line, blanks end one, newlines are dropped */
+    for (size_t i = 0; i < s->in_len; i++)
+    {
+        char c = in[i];
+        if (c == '.' || c == ';' || c == ':')
+        {
+            *out++ = '\n';
+            *out++ = c;
+        }
+        else if (c == ' ' || c == '\t')
+        {
+            *out++ = '\n';
+        }
+        else if (c != '\n')
+        {
+            *out++ = c;
+        }
+    }
+    s->out_len = (size_t)(out - s->out);
+}
@@ -0,0 +1,48 @@
+/*
+    Program: Block File Copying
+    Context: The C Programming Language, Chapter 1 - File Copying Example, one block at a time
+    Author:  Greg Tate
+    Date:    2026-10-19
+
+    Description: Copies standard input to standard output like 2_char.c, but moves a megabyte per
+    read/write call instead of one character per getchar/putchar. With KR_METRICS=name set, the bytes
+    copied so far are published once per block for metrics_view.c (see live_metrics.h).
+
+    Build: gcc -O2 -std=c17 block_copy.c -o block_copy
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../live_metrics.h"
+
+#define BLOCKSIZE (1 << 20)
+
+int main()
+{
+    static char buf[BLOCKSIZE];
+    struct metrics *metrics = metrics_open("block_copy", 1, NULL);
+    uint64_t copied = 0;
+    ssize_t got;
+
+    // Read and write whole blocks until EOF, retrying short writes
+    while ((got = read(STDIN_FILENO, buf, BLOCKSIZE)) > 0) {
+        for (ssize_t done = 0, n; done < got; done += n) {
+            n = write(STDOUT_FILENO, buf + done, (size_t)(got - done));
+            if (n < 0) {
+                perror("block_copy");
+                return 1;
+            }
+        }
+        copied += (uint64_t)got;
+        metrics_publish(metrics, 0, copied, NULL);
+    }
+    metrics_close(metrics);
+    if (got < 0) {
+        perror("block_copy");
+        return 1;
+    }
+}
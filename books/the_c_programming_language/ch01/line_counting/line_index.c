@@ -0,0 +1,497 @@
+/*
+    Program: Line Index
+    Context: The C Programming Language, Chapter 1 - 1_line_count.c without rescanning the file every time.
+    Description: Builds a sidecar index FILE.lidx holding the position of every newline in FILE. Positions
+                 are stored as varint deltas (one or two bytes per line for ordinary text) with a full
+                 checkpoint every 1024 newlines, so the line count is read straight from the header and
+                 any line is found by one checkpoint lookup plus at most 1023 varint decodes. The index is
+                 built in parallel: one pass counts newlines per chunk and sizes their deltas, so a
+                 second pass can write each chunk's deltas straight to their place through a small
+                 buffer. When FILE has only grown, just the new bytes are indexed; a new inode or mtime
+                 at the old size means it was replaced, and the index is rebuilt. The new index is
+                 written to a uniquely named file beside it and renamed over the old one, so a crash or a
+                 second run at the same time leaves one complete index or the other.
+    Usage: line_index build FILE          build or extend the index
+           line_index count FILE          number of newlines, as 1_line_count.c prints
+           line_index show FILE N [M]     print lines N through M (1-based)
+    Build: gcc -O2 -std=c17 -pthread line_index.c -o line_index
+    Author: Greg Tate
+    Date: 2026-10-19
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define INDEX_MAGIC "LIDX"
+#define EVERY 1024              // Newlines per checkpoint
+#define MAXTHREADS 64
+#define MINCHUNK (1 << 22)      // Smallest chunk worth a thread
+#define COPYSIZE (1 << 16)
+
+// Fixed header at the start of the index; the delta stream follows, then the checkpoint table
+struct header {
+    char magic[4];
+    uint32_t every;
+    uint64_t size;              // Bytes of FILE covered by the index
+    uint64_t newlines;
+    uint64_t last_end;          // One past the last newline (0 when there is none)
+    uint64_t stream_bytes;
+    uint64_t ncheckpoints;
+    uint64_t inode;             // FILE's inode and modification time when it was indexed
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+};
+
+// Checkpoint c describes newline c * EVERY
+struct checkpoint {
+    uint64_t end;               // One past that newline, i.e. where the next line starts
+    uint64_t pos;               // Stream offset just after its delta
+};
+
+struct chunk {
+    const char *data;
+    uint64_t lo, hi;
+    uint64_t newlines;          // Pass 1: newlines in [lo, hi)
+    uint64_t first_end, last_end;
+    uint64_t inner_bytes;       // Pass 1: encoded size of every delta but the first
+    uint64_t first_index;       // Pass 2: global number of the chunk's first newline
+    uint64_t prev_end;          // One past the newline before the chunk
+    uint64_t stream_pos;        // Stream offset of the chunk's first delta
+    off_t stream_at;            // Where the chunk's deltas and checkpoints go in the new index
+    off_t checkpoints_at;
+    int fd;
+    int ok;
+};
+
+struct index {
+    struct header h;
+    const unsigned char *stream;
+    const struct checkpoint *checkpoints;
+    void *map;
+    size_t map_size;
+};
+
+int build_index(const char *path, int nthreads);
+int open_index(const char *path, struct index *ix);
+int line_end(const struct index *ix, uint64_t n, uint64_t *end);
+int show_lines(const char *path, const struct index *ix, uint64_t first, uint64_t last);
+char *index_name(const char *path, const char *suffix);
+
+int main(int argc, char *argv[])
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int nthreads = ncpu > 0 ? (int)ncpu : 1;
+    struct index ix;
+
+    if (nthreads > MAXTHREADS) {
+        nthreads = MAXTHREADS;
+    }
+    if (argc < 3 || (strcmp(argv[1], "show") == 0 && argc < 4)) {
+        fprintf(stderr, "usage: %s build|count FILE\n       %s show FILE N [M]\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    // Every command first brings the index up to date; a current index is only opened for reading
+    if (!build_index(argv[2], nthreads)) {
+        return 1;
+    }
+    if (strcmp(argv[1], "build") == 0) {
+        return 0;
+    }
+    if (!open_index(argv[2], &ix)) {
+        return 1;
+    }
+    if (strcmp(argv[1], "count") == 0) {
+        printf("%llu\n", (unsigned long long)ix.h.newlines);
+        return 0;
+    }
+    if (strcmp(argv[1], "show") == 0) {
+        uint64_t first = strtoull(argv[3], NULL, 10);
+        uint64_t last = argc > 4 ? strtoull(argv[4], NULL, 10) : first;
+        return show_lines(argv[2], &ix, first, last) ? 0 : 1;
+    }
+    fprintf(stderr, "%s: unknown command %s\n", argv[0], argv[1]);
+    return 2;
+}
+
+static uint64_t varint_size(uint64_t v)
+{
+    uint64_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+// Checkpoints for newlines numbered below n
+static uint64_t checkpoints_below(uint64_t n)
+{
+    return (n + EVERY - 1) / EVERY;
+}
+
+// The header must describe exactly the index that holds it before any offset in it is used
+static int header_ok(const struct header *h, uint64_t index_size)
+{
+    uint64_t rest;
+
+    if (memcmp(h->magic, INDEX_MAGIC, 4) != 0 || h->every != EVERY || index_size < sizeof *h) {
+        return 0;
+    }
+    rest = index_size - sizeof *h;
+    return h->stream_bytes <= rest && h->ncheckpoints == checkpoints_below(h->newlines) &&
+           h->ncheckpoints == (rest - h->stream_bytes) / sizeof(struct checkpoint) &&
+           (rest - h->stream_bytes) % sizeof(struct checkpoint) == 0 && h->newlines <= h->stream_bytes &&
+           h->last_end <= h->size;
+}
+
+static void *count_chunk(void *arg)
+{
+    struct chunk *c = arg;
+    const char *p = c->data + c->lo, *end = c->data + c->hi;
+
+    // Pass 1: count newlines and size their deltas; the first delta depends on the chunk before
+    while (p < end && (p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        uint64_t pos_end = (uint64_t)(++p - c->data);
+        if (c->newlines++ == 0) {
+            c->first_end = pos_end;
+        } else {
+            c->inner_bytes += varint_size(pos_end - c->last_end);
+        }
+        c->last_end = pos_end;
+    }
+    return NULL;
+}
+
+static int put(int fd, const void *buf, size_t n, off_t at)
+{
+    return pwrite(fd, buf, n, at) == (ssize_t)n;
+}
+
+static void *encode_chunk(void *arg)
+{
+    struct chunk *c = arg;
+    const char *p = c->data + c->lo, *end = c->data + c->hi;
+    uint64_t prev = c->prev_end, index = c->first_index, pos = c->stream_pos;
+    unsigned char out[COPYSIZE];
+    struct checkpoint cps[COPYSIZE / sizeof(struct checkpoint)];
+    size_t nout = 0, ncps = 0;
+    off_t out_at = c->stream_at, cps_at = c->checkpoints_at;
+    int ok = 1;
+
+    // Pass 2: a varint delta per newline and a checkpoint whenever the global number is a multiple of
+    // EVERY, both flushed to their known place in the new index whenever a buffer fills
+    while (ok && p < end && (p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        uint64_t pos_end = (uint64_t)(++p - c->data);
+        uint64_t delta = pos_end - prev;
+        size_t start = nout;
+        if (nout + 10 > sizeof out) {
+            ok = put(c->fd, out, nout, out_at);
+            out_at += (off_t)nout;
+            nout = start = 0;
+        }
+        while (delta >= 0x80) {
+            out[nout++] = (unsigned char)(delta | 0x80);
+            delta >>= 7;
+        }
+        out[nout++] = (unsigned char)delta;
+        pos += nout - start;
+        if (index % EVERY == 0) {
+            cps[ncps++] = (struct checkpoint){pos_end, pos};
+            if (ncps == sizeof cps / sizeof cps[0]) {
+                ok = ok && put(c->fd, cps, sizeof cps, cps_at);
+                cps_at += (off_t)sizeof cps;
+                ncps = 0;
+            }
+        }
+        prev = pos_end;
+        index++;
+    }
+    c->ok = ok && put(c->fd, out, nout, out_at) && put(c->fd, cps, ncps * sizeof cps[0], cps_at);
+    return NULL;
+}
+
+// Run fn over every chunk, one thread each; a chunk whose thread cannot start runs here
+static void run_chunks(void *(*fn)(void *), struct chunk *chunks, int n)
+{
+    pthread_t tid[MAXTHREADS];
+    int started[MAXTHREADS];
+
+    for (int t = 0; t < n; t++) {
+        started[t] = pthread_create(&tid[t], NULL, fn, &chunks[t]) == 0;
+        if (!started[t]) {
+            fn(&chunks[t]);
+        }
+    }
+    for (int t = 0; t < n; t++) {
+        if (started[t]) {
+            pthread_join(tid[t], NULL);
+        }
+    }
+}
+
+static int copy_range(int from_fd, off_t from, int to_fd, off_t to, uint64_t n)
+{
+    static char buf[COPYSIZE];
+
+    while (n > 0) {
+        size_t want = n < COPYSIZE ? (size_t)n : COPYSIZE;
+        ssize_t got = pread(from_fd, buf, want, from);
+        if (got <= 0 || !put(to_fd, buf, (size_t)got, to)) {
+            return 0;
+        }
+        from += got;
+        to += got;
+        n -= (uint64_t)got;
+    }
+    return 1;
+}
+
+int build_index(const char *path, int nthreads)
+{
+    char *name = index_name(path, ".lidx"), *tmp;
+    int fd = open(path, O_RDONLY), ifd, tfd;
+    struct stat st, ist;
+    struct header old, h;
+    static struct chunk chunks[MAXTHREADS];
+    char *data = NULL;
+    int reuse, ok = 1;
+
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(path);
+        return 0;
+    }
+
+    // An index of the same file at the same size and mtime is current and is left alone
+    ifd = open(name, O_RDONLY);
+    reuse = ifd >= 0 && fstat(ifd, &ist) == 0 && pread(ifd, &old, sizeof old, 0) == (ssize_t)sizeof old &&
+            header_ok(&old, (uint64_t)ist.st_size) && old.inode == (uint64_t)st.st_ino &&
+            old.size <= (uint64_t)st.st_size;
+    if (reuse && old.size == (uint64_t)st.st_size && old.mtime_sec == (int64_t)st.st_mtim.tv_sec &&
+        old.mtime_nsec == (int64_t)st.st_mtim.tv_nsec) {
+        close(fd);
+        close(ifd);
+        free(name);
+        return 1;
+    }
+    if (st.st_size > 0) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror(path);
+            return 0;
+        }
+    }
+    close(fd);
+
+    // A file that only grew keeps its old entries; the same size with a new mtime, or a byte that is no
+    // longer the last indexed newline, means it was rewritten
+    if (reuse && (old.size == (uint64_t)st.st_size || (old.last_end > 0 && data[old.last_end - 1] != '\n'))) {
+        reuse = 0;
+    }
+    if (!reuse) {
+        memset(&old, 0, sizeof old);
+    }
+
+    // Pass 1 over the bytes past the indexed size
+    uint64_t from = old.size, to = (uint64_t)st.st_size;
+    if ((to - from) / MINCHUNK + 1 < (uint64_t)nthreads) {
+        nthreads = (int)((to - from) / MINCHUNK + 1);
+    }
+    for (int t = 0; t < nthreads; t++) {
+        chunks[t] = (struct chunk){.data = data,
+                                   .lo = from + (to - from) * (uint64_t)t / (uint64_t)nthreads,
+                                   .hi = from + (to - from) * (uint64_t)(t + 1) / (uint64_t)nthreads};
+    }
+    run_chunks(count_chunk, chunks, nthreads);
+
+    // Prefix sums give each chunk its first newline number, the newline before it, and the stream offset
+    // of its deltas, so the new header is known before anything is encoded
+    h = old;
+    memcpy(h.magic, INDEX_MAGIC, 4);
+    h.every = EVERY;
+    for (int t = 0; t < nthreads; t++) {
+        struct chunk *c = &chunks[t];
+        c->first_index = h.newlines;
+        c->prev_end = h.last_end;
+        c->stream_pos = h.stream_bytes;
+        if (c->newlines > 0) {
+            h.stream_bytes += varint_size(c->first_end - c->prev_end) + c->inner_bytes;
+            h.newlines += c->newlines;
+            h.last_end = c->last_end;
+        }
+    }
+    h.ncheckpoints = checkpoints_below(h.newlines);
+    h.size = to;
+    h.inode = (uint64_t)st.st_ino;
+    h.mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    h.mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+
+    // Write a new index beside the old one: old deltas, new deltas, old checkpoints, new checkpoints.
+    // Each run gets its own file, so runs at the same time never write into one another's
+    tmp = index_name(path, ".lidx.XXXXXX");
+    tfd = mkstemp(tmp);
+    if (tfd < 0 || fchmod(tfd, 0644) != 0) {
+        perror(tmp);
+        return 0;
+    }
+    ok = copy_range(ifd, (off_t)sizeof old, tfd, (off_t)sizeof h, old.stream_bytes) &&
+         copy_range(ifd, (off_t)(sizeof old + old.stream_bytes), tfd, (off_t)(sizeof h + h.stream_bytes),
+                    old.ncheckpoints * sizeof(struct checkpoint));
+    for (int t = 0; t < nthreads; t++) {
+        struct chunk *c = &chunks[t];
+        c->fd = tfd;
+        c->stream_at = (off_t)(sizeof h + c->stream_pos);
+        c->checkpoints_at =
+            (off_t)(sizeof h + h.stream_bytes + checkpoints_below(c->first_index) * sizeof(struct checkpoint));
+    }
+    if (ok) {
+        run_chunks(encode_chunk, chunks, nthreads);
+    }
+    for (int t = 0; t < nthreads; t++) {
+        ok = ok && chunks[t].ok;
+    }
+
+    // The header goes last; the rename replaces the old index only once the new one is complete
+    ok = ok && put(tfd, &h, sizeof h, 0) && fsync(tfd) == 0;
+    ok = (close(tfd) == 0) & ok;
+    ok = ok && rename(tmp, name) == 0;
+    if (!ok) {
+        perror(tmp);
+        unlink(tmp);
+    }
+    if (data != NULL) {
+        munmap(data, (size_t)to);
+    }
+    if (ifd >= 0) {
+        close(ifd);
+    }
+    free(tmp);
+    free(name);
+    return ok;
+}
+
+int open_index(const char *path, struct index *ix)
+{
+    char *name = index_name(path, ".lidx");
+    int fd = open(name, O_RDONLY);
+    struct stat st;
+
+    // Map the whole index; the delta stream and checkpoints are used in place
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(name);
+        return 0;
+    }
+    if (pread(fd, &ix->h, sizeof ix->h, 0) != (ssize_t)sizeof ix->h || !header_ok(&ix->h, (uint64_t)st.st_size)) {
+        fprintf(stderr, "line_index: %s is damaged\n", name);
+        close(fd);
+        return 0;
+    }
+    ix->map_size = (size_t)st.st_size;
+    ix->map = mmap(NULL, ix->map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ix->map == MAP_FAILED) {
+        perror(name);
+        return 0;
+    }
+    ix->stream = (const unsigned char *)ix->map + sizeof ix->h;
+    ix->checkpoints = (const struct checkpoint *)(ix->stream + ix->h.stream_bytes);
+    free(name);
+    return 1;
+}
+
+int line_end(const struct index *ix, uint64_t n, uint64_t *end)
+{
+    const unsigned char *stop = ix->stream + ix->h.stream_bytes;
+    struct checkpoint cp;
+
+    // One past newline n (0-based): jump to its checkpoint (copied out, the table may be unaligned), then decode forward
+    memcpy(&cp, (const char *)ix->checkpoints + n / EVERY * sizeof cp, sizeof cp);
+    if (cp.pos > ix->h.stream_bytes) {
+        return 0;
+    }
+    *end = cp.end;
+    const unsigned char *p = ix->stream + cp.pos;
+
+    // Every read stays inside the stream, so a damaged index is reported rather than followed
+    for (uint64_t k = n % EVERY; k > 0; k--) {
+        uint64_t delta = 0;
+        int shift = 0;
+        while (p < stop && (*p & 0x80) && shift < 63) {
+            delta |= (uint64_t)(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (p == stop || (*p & 0x80)) {
+            return 0;
+        }
+        delta |= (uint64_t)*p++ << shift;
+        *end += delta;
+    }
+    return *end <= ix->h.size;
+}
+
+int show_lines(const char *path, const struct index *ix, uint64_t first, uint64_t last)
+{
+    uint64_t nlines = ix->h.newlines + (ix->h.last_end < ix->h.size);   // A last line may lack its newline
+    static char buf[COPYSIZE];
+    uint64_t start, stop;
+    int fd;
+
+    if (first < 1 || last < first || first > nlines) {
+        fprintf(stderr, "line_index: %s has %llu lines\n", path, (unsigned long long)nlines);
+        return 0;
+    }
+    if (last > nlines) {
+        last = nlines;
+    }
+
+    // Line N starts after newline N-1 and ends after newline N (or at the end of the file)
+    start = 0;
+    stop = ix->h.size;
+    if ((first > 1 && !line_end(ix, first - 2, &start)) || (last <= ix->h.newlines && !line_end(ix, last - 1, &stop))) {
+        fprintf(stderr, "line_index: the index of %s is damaged\n", path);
+        return 0;
+    }
+
+    // Copy just that byte range out of the data file
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 0;
+    }
+    while (start < stop) {
+        size_t want = stop - start < COPYSIZE ? (size_t)(stop - start) : COPYSIZE;
+        ssize_t got = pread(fd, buf, want, (off_t)start);
+        if (got <= 0) {
+            perror(path);
+            close(fd);
+            return 0;
+        }
+        fwrite(buf, 1, (size_t)got, stdout);
+        start += (uint64_t)got;
+    }
+    close(fd);
+    return 1;
+}
+
+char *index_name(const char *path, const char *suffix)
+{
+    size_t len = strlen(path), slen = strlen(suffix);
+    char *name = malloc(len + slen + 1);
+
+    if (name == NULL) {
+        fprintf(stderr, "line_index: out of memory\n");
+        exit(1);
+    }
+    memcpy(name, path, len);
+    memcpy(name + len, suffix, slen + 1);
+    return name;
+}
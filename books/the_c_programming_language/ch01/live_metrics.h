@@ -0,0 +1,156 @@
+/*
+    Header: Live Metrics
+    Context: The C Programming Language, Chapter 1 - progress reporting for the long-running ch01 tools
+    Description: Opt-in progress counters in a POSIX shared-memory segment. Setting KR_METRICS=name in the
+                 environment makes a tool create /kr_metrics_name; metrics_view.c reads it from another
+                 process. Each worker thread owns one cache-line-aligned slot guarded by its own seqlock,
+                 so publishing touches only that thread's line and the reader never blocks the writer.
+                 Without KR_METRICS, metrics_open returns NULL and metrics_publish returns at once.
+    Author: Greg Tate
+    Date: 2026-10-19
+*/
+
+#ifndef LIVE_METRICS_H
+#define LIVE_METRICS_H
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define METRICS_MAGIC 0x4B524D31u      // "KRM1"
+#define METRICS_SLOTS 64               // Worker threads that can report
+#define METRICS_COUNTERS 3             // Tool-defined counters per slot (lines, words, ...)
+#define METRICS_LABEL 16
+
+// One thread's numbers; seq is odd while the owner is writing
+struct metrics_slot {
+    _Alignas(64) atomic_uint seq;
+    atomic_uint_least64_t bytes;
+    atomic_uint_least64_t counters[METRICS_COUNTERS];
+};
+
+struct metrics {
+    uint32_t magic;
+    uint32_t nslots;
+    char tool[METRICS_LABEL];
+    char labels[METRICS_COUNTERS][METRICS_LABEL];
+    uint64_t started_ns;
+    atomic_int done;
+    struct metrics_slot slots[METRICS_SLOTS];
+};
+
+static inline uint64_t metrics_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static inline void metrics_shm_name(char *out, size_t size, const char *name)
+{
+    snprintf(out, size, "/kr_metrics_%s", name);
+}
+
+// Create the segment named by $KR_METRICS, or return NULL when metrics are off
+static inline struct metrics *metrics_open(const char *tool, unsigned nslots, const char *const labels[])
+{
+    const char *name = getenv("KR_METRICS");
+    char path[128];
+    struct metrics *m;
+    int fd;
+
+    if (name == NULL || *name == '\0') {
+        return NULL;
+    }
+    metrics_shm_name(path, sizeof path, name);
+    fd = shm_open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof *m) != 0) {
+        perror(path);
+        close(fd);
+        shm_unlink(path);
+        return NULL;
+    }
+    m = mmap(NULL, sizeof *m, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        perror(path);
+        shm_unlink(path);
+        return NULL;
+    }
+
+    // Labels are written once, before the magic makes the segment visible to viewers
+    m->nslots = nslots < METRICS_SLOTS ? nslots : METRICS_SLOTS;
+    snprintf(m->tool, sizeof m->tool, "%s", tool);
+    for (int i = 0; i < METRICS_COUNTERS && labels != NULL && labels[i] != NULL; i++) {
+        snprintf(m->labels[i], sizeof m->labels[i], "%s", labels[i]);
+    }
+    m->started_ns = metrics_now();
+    atomic_thread_fence(memory_order_release);
+    m->magic = METRICS_MAGIC;
+    return m;
+}
+
+// Publish a thread's running totals; called once per block, never per byte
+static inline void metrics_publish(struct metrics *m, unsigned slot, uint64_t bytes,
+                                   const uint64_t counters[METRICS_COUNTERS])
+{
+    struct metrics_slot *s;
+    unsigned seq;
+
+    if (m == NULL) {
+        return;
+    }
+    s = &m->slots[slot];
+    seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&s->bytes, bytes, memory_order_relaxed);
+    for (int i = 0; i < METRICS_COUNTERS; i++) {
+        atomic_store_explicit(&s->counters[i], counters ? counters[i] : 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+}
+
+// Take a consistent copy of one slot, retrying while its owner is mid-update
+static inline void metrics_read(struct metrics *m, unsigned slot, uint64_t *bytes,
+                                uint64_t counters[METRICS_COUNTERS])
+{
+    struct metrics_slot *s = &m->slots[slot];
+    unsigned before, after;
+
+    do {
+        before = atomic_load_explicit(&s->seq, memory_order_acquire);
+        *bytes = atomic_load_explicit(&s->bytes, memory_order_relaxed);
+        for (int i = 0; i < METRICS_COUNTERS; i++) {
+            counters[i] = atomic_load_explicit(&s->counters[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+}
+
+// Mark the run finished and remove the name; a viewer that has it mapped still sees the final numbers
+static inline void metrics_close(struct metrics *m)
+{
+    char path[128];
+
+    if (m == NULL) {
+        return;
+    }
+    atomic_store_explicit(&m->done, 1, memory_order_release);
+    metrics_shm_name(path, sizeof path, getenv("KR_METRICS"));
+    shm_unlink(path);
+    munmap(m, sizeof *m);
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+    Program: Live Metrics Viewer
+    Context: The C Programming Language, Chapter 1 - companion to live_metrics.h
+    Description: Attaches to the shared-memory metrics of a running ch01 tool started with KR_METRICS=name
+                 and prints, every interval, the bytes processed, the tool's counters, and the throughput of
+                 each worker thread since the previous sample. Only reads the segment, so the tool being
+                 watched is never paused. Stops when the tool reports that it is done.
+    Usage: metrics_view name [interval_ms]
+    Build: gcc -O2 -std=c17 metrics_view.c -o metrics_view
+    Author: Greg Tate
+    Date: 2026-10-19
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sys/stat.h>
+
+#include "live_metrics.h"
+
+int main(int argc, char *argv[])
+{
+    char path[128];
+    struct metrics *m = NULL;
+    long interval_ms = argc > 2 ? atol(argv[2]) : 1000;
+    uint64_t prev_bytes[METRICS_SLOTS] = {0};
+    uint64_t prev_ns;
+    struct timespec pause;
+    int fd = -1;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s name [interval_ms]\n", argv[0]);
+        return 2;
+    }
+    if (interval_ms <= 0) {
+        interval_ms = 1000;
+    }
+    pause.tv_sec = interval_ms / 1000;
+    pause.tv_nsec = (interval_ms % 1000) * 1000000L;
+
+    // Wait for the tool to create and initialize its segment
+    metrics_shm_name(path, sizeof path, argv[1]);
+    for (int tries = 0; m == NULL && tries < 50; tries++) {
+        struct stat st;
+
+        fd = shm_open(path, O_RDONLY, 0);
+        // The segment exists before it is sized; mapping it then would fault on the first read
+        if (fd >= 0 && (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof *m)) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) {
+            m = mmap(NULL, sizeof *m, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (m == MAP_FAILED) {
+                m = NULL;
+            } else if (m->magic != METRICS_MAGIC) {
+                munmap(m, sizeof *m);
+                m = NULL;
+            }
+        }
+        if (m == NULL) {
+            nanosleep(&(struct timespec){0, 100000000L}, NULL);
+        }
+    }
+    if (m == NULL) {
+        fprintf(stderr, "metrics_view: no metrics named %s\n", argv[1]);
+        return 1;
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    // Sample every interval; the last sample is taken after the tool says it is done
+    prev_ns = m->started_ns;
+    for (;;) {
+        int done = atomic_load_explicit(&m->done, memory_order_acquire);
+        uint64_t now = metrics_now();
+        double seconds = (double)(now - prev_ns) / 1e9;
+        uint64_t total = 0;
+
+        printf("%s  %.1fs\n", m->tool, (double)(now - m->started_ns) / 1e9);
+        for (unsigned i = 0; i < m->nslots; i++) {
+            uint64_t bytes, counters[METRICS_COUNTERS];
+            metrics_read(m, i, &bytes, counters);
+            printf("  [%2u] %14llu bytes %9.1f MB/s", i, (unsigned long long)bytes,
+                   seconds > 0 ? (double)(bytes - prev_bytes[i]) / seconds / 1e6 : 0.0);
+            for (int k = 0; k < METRICS_COUNTERS; k++) {
+                if (m->labels[k][0] != '\0') {
+                    printf("  %s %llu", m->labels[k], (unsigned long long)counters[k]);
+                }
+            }
+            printf("\n");
+            prev_bytes[i] = bytes;
+            total += bytes;
+        }
+        printf("  total %llu bytes\n", (unsigned long long)total);
+        fflush(stdout);
+        if (done) {
+            break;
+        }
+        prev_ns = now;
+        nanosleep(&pause, NULL);
+    }
+    munmap(m, sizeof *m);
+    return 0;
+}
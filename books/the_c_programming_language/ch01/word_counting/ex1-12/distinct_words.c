@@ -0,0 +1,275 @@
+/*
+    Program: Estimate Distinct Words
+    Context: The C Programming Language, Chapter 1, Exercise 1-12 - splits words the way echo_input.c does
+    Description: Estimates how many distinct words the input has with a HyperLogLog sketch, so memory stays
+                 at 2^precision bytes no matter how large the corpus is. Each word is hashed and only the
+                 longest run of leading zero bits per register is kept. A regular file argument is split
+                 across threads, each filling its own sketch, and the sketches are merged by taking the
+                 maximum of each register; a pipe, FIFO or /dev/stdin path is read as a stream. Sketches
+                 can be saved with -o and merged back in with -m, so counts over partitions or days combine
+                 without rescanning the text.
+    Usage: distinct_words [-p precision] [-t threads] [-o out.hll] [-m in.hll]... [file | -]
+           With no file and no -m, reads stdin. Precision is 4..18 (default 14, about 0.8% error).
+    Build: gcc -O2 -std=c17 -pthread distinct_words.c -lm -o distinct_words
+    Author: Greg Tate
+    Date: 2026-10-19
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../word_scan.h"
+
+#define MIN_PRECISION 4
+#define MAX_PRECISION 18
+#define DEFAULT_PRECISION 14
+#define SKETCH_MAGIC "HLL1"
+
+struct hll {
+    int precision;
+    uint8_t *registers;         // 2^precision ranks
+};
+
+int hll_init(struct hll *h, int precision);
+void hll_add(struct hll *h, uint64_t hash);
+void hll_merge(struct hll *into, const struct hll *from);
+double hll_estimate(const struct hll *h);
+int hll_save(const struct hll *h, const char *path);
+int hll_load(struct hll *h, const char *path);
+uint64_t hash_word(const char *s, size_t n);
+int add_word(void *ctx, const char *word, size_t len);
+int scan_file_sketch(struct hll *h, const char *path, int nthreads);
+
+int main(int argc, char *argv[])
+{
+    int precision = DEFAULT_PRECISION;
+    int precision_given = 0;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int nthreads = ncpu > 0 ? (int)ncpu : 1;
+    const char *out = NULL, *path = NULL;
+    const char *merges[256];
+    int nmerges = 0;
+    struct hll total;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            precision = atoi(argv[++i]);
+            precision_given = 1;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            nthreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc && nmerges < 256) {
+            merges[nmerges++] = argv[++i];
+        } else if (path == NULL && (argv[i][0] != '-' || argv[i][1] == '\0')) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-p precision] [-t threads] [-o out.hll] [-m in.hll]... [file | -]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+    if (nthreads > SCAN_MAXTHREADS) {
+        nthreads = SCAN_MAXTHREADS;
+    }
+
+    // Saved sketches must agree on precision; the first one loaded sets it unless -p was given
+    if (nmerges > 0) {
+        if (!hll_load(&total, merges[0])) {
+            return 1;
+        }
+        if (precision_given && precision != total.precision) {
+            fprintf(stderr, "distinct_words: %s has precision %d, but -p %d was given\n", merges[0],
+                    total.precision, precision);
+            return 2;
+        }
+        precision = total.precision;
+    } else if (!hll_init(&total, precision)) {
+        fprintf(stderr, "distinct_words: precision must be %d..%d\n", MIN_PRECISION, MAX_PRECISION);
+        return 2;
+    }
+    for (int i = 1; i < nmerges; i++) {
+        struct hll other;
+        if (!hll_load(&other, merges[i])) {
+            return 1;
+        }
+        if (other.precision != total.precision) {
+            fprintf(stderr, "distinct_words: %s has precision %d, expected %d\n", merges[i], other.precision,
+                    total.precision);
+            return 1;
+        }
+        hll_merge(&total, &other);
+        free(other.registers);
+    }
+
+    // Scan text: a named file in parallel, stdin as a stream
+    if (path != NULL && strcmp(path, "-") != 0) {
+        if (!scan_file_sketch(&total, path, nthreads)) {
+            return 1;
+        }
+    } else if (path != NULL || nmerges == 0) {
+        if (!scan_stream(stdin, 1, add_word, &total)) {
+            return 1;
+        }
+    }
+
+    if (out != NULL && !hll_save(&total, out)) {
+        return 1;
+    }
+    printf("%.0f\n", hll_estimate(&total));
+    return 0;
+}
+
+int hll_init(struct hll *h, int precision)
+{
+    if (precision < MIN_PRECISION || precision > MAX_PRECISION) {
+        return 0;
+    }
+    h->precision = precision;
+    h->registers = calloc((size_t)1 << precision, 1);
+    return h->registers != NULL;
+}
+
+void hll_add(struct hll *h, uint64_t hash)
+{
+    // Top bits pick the register, the rank of the remaining bits is the evidence
+    size_t index = (size_t)(hash >> (64 - h->precision));
+    uint64_t rest = (hash << h->precision) | ((uint64_t)1 << (h->precision - 1));
+    uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+
+    if (rank > h->registers[index]) {
+        h->registers[index] = rank;
+    }
+}
+
+void hll_merge(struct hll *into, const struct hll *from)
+{
+    // The union of two sets is the register-wise maximum
+    size_t m = (size_t)1 << into->precision;
+    for (size_t i = 0; i < m; i++) {
+        if (from->registers[i] > into->registers[i]) {
+            into->registers[i] = from->registers[i];
+        }
+    }
+}
+
+double hll_estimate(const struct hll *h)
+{
+    size_t m = (size_t)1 << h->precision;
+    double sum = 0.0, alpha, estimate;
+    size_t zeros = 0;
+
+    // Harmonic mean of 2^-rank over all registers
+    for (size_t i = 0; i < m; i++) {
+        sum += ldexp(1.0, -h->registers[i]);
+        zeros += h->registers[i] == 0;
+    }
+    if (m == 16) {
+        alpha = 0.673;
+    } else if (m == 32) {
+        alpha = 0.697;
+    } else if (m == 64) {
+        alpha = 0.709;
+    } else {
+        alpha = 0.7213 / (1.0 + 1.079 / (double)m);
+    }
+    estimate = alpha * (double)m * (double)m / sum;
+
+    // Small cardinalities are counted more accurately from the empty registers
+    if (estimate <= 2.5 * (double)m && zeros > 0) {
+        estimate = (double)m * log((double)m / (double)zeros);
+    }
+    return estimate;
+}
+
+int hll_save(const struct hll *h, const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    uint8_t p = (uint8_t)h->precision;
+
+    // Four-byte magic, one precision byte, then the raw registers
+    if (fp == NULL) {
+        perror(path);
+        return 0;
+    }
+    fwrite(SKETCH_MAGIC, 1, 4, fp);
+    fwrite(&p, 1, 1, fp);
+    fwrite(h->registers, 1, (size_t)1 << h->precision, fp);
+    if (ferror(fp) | fclose(fp)) {
+        fprintf(stderr, "distinct_words: error writing %s\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+int hll_load(struct hll *h, const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    char magic[4];
+    uint8_t p;
+
+    if (fp == NULL) {
+        perror(path);
+        return 0;
+    }
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, SKETCH_MAGIC, 4) != 0 || fread(&p, 1, 1, fp) != 1 ||
+        !hll_init(h, p) || fread(h->registers, 1, (size_t)1 << p, fp) != (size_t)1 << p) {
+        fprintf(stderr, "distinct_words: %s is not a sketch file\n", path);
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+    return 1;
+}
+
+uint64_t hash_word(const char *s, size_t n)
+{
+    uint64_t h = hash_bytes(s, n);
+
+    // Final avalanche so the top bits (the register index) depend on every input bit
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    return h ^ (h >> 33);
+}
+
+int add_word(void *ctx, const char *word, size_t len)
+{
+    hll_add(ctx, hash_word(word, len));
+    return 1;
+}
+
+int scan_file_sketch(struct hll *h, const char *path, int nthreads)
+{
+    static struct hll sketches[SCAN_MAXTHREADS];
+    void *ctx[SCAN_MAXTHREADS];
+    int used;
+
+    // One sketch per thread, merged by register maximum; newlines separate words, unlike echo_input.c.
+    // scan_file streams a path it cannot map into the first sketch and reports one used
+    for (int t = 0; t < nthreads; t++) {
+        if (!hll_init(&sketches[t], h->precision)) {
+            fprintf(stderr, "distinct_words: out of memory\n");
+            return 0;
+        }
+        ctx[t] = &sketches[t];
+    }
+    used = scan_file(path, nthreads, 1, add_word, ctx);
+    for (int t = 0; t < used; t++) {
+        hll_merge(h, &sketches[t]);
+    }
+    for (int t = 0; t < nthreads; t++) {
+        free(sketches[t].registers);
+    }
+    return used >= 0;
+}
@@ -0,0 +1,308 @@
+/*
+    Program: Most Frequent Words
+    Context: The C Programming Language, Chapter 1 - word frequencies using the word rule from word_count.c
+    Description: Counts every word exactly and prints the N most common ones. Words are separated by blanks,
+                 tabs, and newlines, as in word_count.c. Each thread owns an open-addressing hash table that
+                 stores the full hash beside each entry, with the word bytes interned into one growing arena
+                 (no allocation per word). The thread tables are merged at the end and the top N are picked
+                 with a bounded min-heap.
+    Usage: word_freq [-n count] [-t threads] [file]     (reads stdin when no file is given)
+    Build: gcc -O2 -std=c17 -pthread word_freq.c -o word_freq
+    Author: Greg Tate
+    Date: 2026-10-19
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../word_scan.h"
+
+#define DEFAULT_TOP 10
+#define INITIAL_SLOTS 4096
+#define INITIAL_ARENA (1 << 20)
+
+// One table slot; an empty slot has count zero
+struct entry {
+    uint64_t hash;
+    uint64_t count;
+    uint64_t offset;            // Word bytes in the table's arena
+    uint32_t length;
+};
+
+struct table {
+    struct entry *slots;
+    size_t mask;
+    size_t used;
+    char *arena;                // Interned word bytes, back to back
+    size_t arena_used, arena_cap;
+};
+
+int table_init(struct table *t);
+int table_add(struct table *t, const char *word, size_t len, uint64_t hash, uint64_t count);
+void table_free(struct table *t);
+int add_word(void *ctx, const char *word, size_t len);
+int scan_file_table(struct table *t, const char *path, int nthreads);
+void print_top(const struct table *t, size_t top);
+
+int main(int argc, char *argv[])
+{
+    size_t top = DEFAULT_TOP;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int nthreads = ncpu > 0 ? (int)ncpu : 1;
+    const char *path = NULL;
+    struct table total;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            top = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            nthreads = atoi(argv[++i]);
+        } else if (path == NULL && (argv[i][0] != '-' || argv[i][1] == '\0')) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-n count] [-t threads] [file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+    if (nthreads > SCAN_MAXTHREADS) {
+        nthreads = SCAN_MAXTHREADS;
+    }
+
+    // Count a named file in parallel, stdin as a stream
+    if (!table_init(&total)) {
+        fprintf(stderr, "word_freq: out of memory\n");
+        return 1;
+    }
+    if (path != NULL && strcmp(path, "-") != 0) {
+        if (!scan_file_table(&total, path, nthreads)) {
+            return 1;
+        }
+    } else if (!scan_stream(stdin, 0, add_word, &total)) {
+        return 1;
+    }
+
+    print_top(&total, top);
+    table_free(&total);
+    return 0;
+}
+
+int table_init(struct table *t)
+{
+    t->slots = calloc(INITIAL_SLOTS, sizeof(struct entry));
+    t->mask = INITIAL_SLOTS - 1;
+    t->used = 0;
+    t->arena = NULL;
+    t->arena_used = t->arena_cap = 0;
+    return t->slots != NULL;
+}
+
+static int table_grow(struct table *t)
+{
+    size_t size = (t->mask + 1) * 2;
+    struct entry *slots = calloc(size, sizeof(struct entry));
+
+    if (slots == NULL) {
+        return 0;
+    }
+
+    // Stored hashes let entries move without touching the word bytes
+    for (size_t i = 0; i <= t->mask; i++) {
+        if (t->slots[i].count == 0) {
+            continue;
+        }
+        size_t j = t->slots[i].hash & (size - 1);
+        while (slots[j].count != 0) {
+            j = (j + 1) & (size - 1);
+        }
+        slots[j] = t->slots[i];
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->mask = size - 1;
+    return 1;
+}
+
+int table_add(struct table *t, const char *word, size_t len, uint64_t hash, uint64_t count)
+{
+    size_t j = hash & t->mask;
+
+    // Probe linearly; the stored hash rules out almost every mismatch before memcmp
+    while (t->slots[j].count != 0) {
+        struct entry *e = &t->slots[j];
+        if (e->hash == hash && e->length == len && memcmp(t->arena + e->offset, word, len) == 0) {
+            e->count += count;
+            return 1;
+        }
+        j = (j + 1) & t->mask;
+    }
+
+    // New word: intern its bytes at the end of the arena
+    if (t->arena_used + len > t->arena_cap) {
+        size_t cap = t->arena_cap ? t->arena_cap : INITIAL_ARENA;
+        while (cap < t->arena_used + len) {
+            cap *= 2;
+        }
+        t->arena = realloc(t->arena, cap);
+        if (t->arena == NULL) {
+            return 0;
+        }
+        t->arena_cap = cap;
+    }
+    memcpy(t->arena + t->arena_used, word, len);
+    t->slots[j] = (struct entry){hash, count, t->arena_used, (uint32_t)len};
+    t->arena_used += len;
+
+    // Keep the load factor at or below one half
+    if (++t->used * 2 > t->mask + 1) {
+        return table_grow(t);
+    }
+    return 1;
+}
+
+void table_free(struct table *t)
+{
+    free(t->slots);
+    free(t->arena);
+}
+
+int add_word(void *ctx, const char *word, size_t len)
+{
+    if (!table_add(ctx, word, len, hash_bytes(word, len), 1)) {
+        fprintf(stderr, "word_freq: out of memory\n");
+        return 0;
+    }
+    return 1;
+}
+
+int scan_file_table(struct table *t, const char *path, int nthreads)
+{
+    static struct table tables[SCAN_MAXTHREADS];
+    void *ctx[SCAN_MAXTHREADS];
+    int used, ok;
+
+    // One table per thread; the first reuses the caller's table
+    tables[0] = *t;
+    ctx[0] = &tables[0];
+    for (int i = 1; i < nthreads; i++) {
+        if (!table_init(&tables[i])) {
+            fprintf(stderr, "word_freq: out of memory\n");
+            return 0;
+        }
+        ctx[i] = &tables[i];
+    }
+    used = scan_file(path, nthreads, 0, add_word, ctx);
+    ok = used >= 0;
+
+    // Fold the other tables into the first, reusing their stored hashes
+    *t = tables[0];
+    for (int i = 1; i < nthreads; i++) {
+        const struct table *from = &tables[i];
+        for (size_t j = 0; ok && i < used && j <= from->mask; j++) {
+            const struct entry *e = &from->slots[j];
+            if (e->count != 0) {
+                ok = table_add(t, from->arena + e->offset, e->length, e->hash, e->count);
+                if (!ok) {
+                    fprintf(stderr, "word_freq: out of memory\n");
+                }
+            }
+        }
+        table_free(&tables[i]);
+    }
+    return ok;
+}
+
+static const struct table *ranked;
+
+static int ranks_below(const struct entry *a, const struct entry *b)
+{
+    // Lower count ranks below; equal counts are ordered by word so output is deterministic
+    if (a->count != b->count) {
+        return a->count < b->count;
+    }
+    size_t n = a->length < b->length ? a->length : b->length;
+    int r = memcmp(ranked->arena + a->offset, ranked->arena + b->offset, n);
+    return r != 0 ? r > 0 : a->length > b->length;
+}
+
+static void sift_down(const struct entry **heap, size_t n, size_t i)
+{
+    // Restore the min-heap property below position i
+    for (;;) {
+        size_t least = i, l = 2 * i + 1, r = l + 1;
+        if (l < n && ranks_below(heap[l], heap[least])) {
+            least = l;
+        }
+        if (r < n && ranks_below(heap[r], heap[least])) {
+            least = r;
+        }
+        if (least == i) {
+            return;
+        }
+        const struct entry *swap = heap[i];
+        heap[i] = heap[least];
+        heap[least] = swap;
+        i = least;
+    }
+}
+
+void print_top(const struct table *t, size_t top)
+{
+    const struct entry **heap;
+    size_t n = 0;
+
+    if (top > t->used) {
+        top = t->used;
+    }
+    if (top == 0) {
+        return;
+    }
+    heap = malloc(top * sizeof *heap);
+    if (heap == NULL) {
+        fprintf(stderr, "word_freq: out of memory\n");
+        return;
+    }
+    ranked = t;
+
+    // Keep the N best seen so far; the weakest of them sits at the root
+    for (size_t i = 0; i <= t->mask; i++) {
+        const struct entry *e = &t->slots[i];
+        if (e->count == 0) {
+            continue;
+        }
+        if (n < top) {
+            heap[n++] = e;
+            if (n == top) {
+                for (size_t k = top / 2; k-- > 0;) {
+                    sift_down(heap, n, k);
+                }
+            }
+        } else if (ranks_below(heap[0], e)) {
+            heap[0] = e;
+            sift_down(heap, n, 0);
+        }
+    }
+
+    // Pop weakest first into the back of the array, leaving it best first
+    for (size_t k = n / 2; k-- > 0;) {
+        sift_down(heap, n, k);
+    }
+    while (n > 1) {
+        const struct entry *weakest = heap[0];
+        heap[0] = heap[--n];
+        heap[n] = weakest;
+        sift_down(heap, n, 0);
+    }
+    for (size_t i = 0; i < top; i++) {
+        printf("%7llu %.*s\n", (unsigned long long)heap[i]->count, (int)heap[i]->length, t->arena + heap[i]->offset);
+    }
+    free(heap);
+}
@@ -0,0 +1,651 @@
+/*
+    Program: Word Count and Character Histogram over Compressed Input
+    Context: The C Programming Language, Chapter 1 - word_count.c and histogram_frequencies.c for gzip/zstd logs
+    Description: Counts lines, words, and characters (same word rule as word_count.c), or with -h prints a
+                 character frequency histogram, reading plain, gzip, or zstd input without a separate zcat.
+                 A decompression thread inflates straight into blocks from a fixed pool and hands them to
+                 the counting thread through a bounded queue; the counter works on the block in place and
+                 returns it to the pool. A zstd file made of several frames is decoded a frame per thread
+                 and reassembled in order. With KR_METRICS=name set, progress is published once per block
+                 for metrics_view.c (see live_metrics.h).
+    Usage: zword_count [-h] [file]     (reads stdin when no file is given)
+    Build: gcc -O2 -std=c17 -pthread zword_count.c -lz -o zword_count
+           add -DWITH_ZSTD -lzstd for zstd input
+    Author: Greg Tate
+    Date: 2026-10-19
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "../live_metrics.h"
+
+#define IN 1                    /* inside a word */
+#define OUT 0                   /* outside a word */
+
+#define BLOCKSIZE (1 << 20)     // Decompressed bytes per block
+#define NBLOCKS 8               // Blocks in flight; bounds memory at NBLOCKS * BLOCKSIZE
+#define READSIZE (1 << 18)      // Compressed bytes read at a time
+#define ASCII_OFFSET 32
+
+struct block {
+    char *data;
+    size_t len;                 // Zero marks the end of the stream
+    void (*release)(struct block *b);  // Hands the block back once it has been counted
+};
+
+// Bounded ring of block pointers shared by one producer and one consumer
+struct queue {
+    struct block *items[NBLOCKS];
+    int head, count;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty, not_full;
+};
+
+struct counts {
+    unsigned long long nl, nw, nc;
+    unsigned long long freq[256];
+    int state;
+};
+
+static struct queue free_blocks, full_blocks;
+static struct block pool[NBLOCKS];
+static FILE *input;
+static int failed;
+
+#ifdef WITH_ZSTD
+#define MAXDECODERS 8
+#define FRAMEMAX (1 << 24)      // Largest frame decoded on a worker thread; bigger ones are streamed
+#define FRAMEHEADER_MAX 18      // Longest zstd frame header
+
+enum frame_state { FRAME_FREE, FRAME_READY, FRAME_BUSY, FRAME_DONE, FRAME_QUEUED };
+
+// One zstd frame in flight: its compressed bytes and, once a decoder is done with it, its content,
+// which goes to the counter as a block of its own (first, so the block leads back to the frame)
+struct frame {
+    struct block block;
+    enum frame_state state;
+    long seq;
+    unsigned char *src;
+    size_t src_len, src_cap;
+    char *out;
+    size_t out_len, out_cap;
+    int ok;
+};
+
+// Compressed input read ahead so whole frames can be handed to the decoders
+struct zinput {
+    unsigned char *buf;
+    size_t pos, len, cap;
+};
+
+static struct frame *frames;
+static int window;
+static long next_decode;
+static int decoders_quit;
+static struct block *current;   // Block the reader is filling
+static pthread_mutex_t frame_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t frame_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t frame_done = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t frame_freed = PTHREAD_COND_INITIALIZER;
+#endif
+
+void queue_init(struct queue *q);
+void return_to_pool(struct block *b);
+void queue_push(struct queue *q, struct block *b);
+struct block *queue_pop(struct queue *q);
+void *decompress(void *arg);
+int read_plain(unsigned char *pending, size_t npending);
+int read_gzip(unsigned char *pending, size_t npending);
+int read_zstd(unsigned char *pending, size_t npending);
+void count_block(struct counts *c, const char *s, size_t n, int histogram);
+void print_histogram(const struct counts *c);
+
+int main(int argc, char *argv[])
+{
+    int histogram = 0;
+    const char *path = NULL;
+    pthread_t producer;
+    static struct counts counts;
+    const char *labels[] = {"lines", "words", NULL};
+    struct metrics *metrics;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0) {
+            histogram = 1;
+        } else if (path == NULL) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-h] [file]\n", argv[0]);
+            return 2;
+        }
+    }
+    input = (path == NULL || strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (input == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    // Fill the free pool and start the decompression thread
+    queue_init(&free_blocks);
+    queue_init(&full_blocks);
+    for (int i = 0; i < NBLOCKS; i++) {
+        pool[i].data = malloc(BLOCKSIZE);
+        pool[i].release = return_to_pool;
+        if (pool[i].data == NULL) {
+            fprintf(stderr, "zword_count: out of memory\n");
+            return 1;
+        }
+        queue_push(&free_blocks, &pool[i]);
+    }
+    if (pthread_create(&producer, NULL, decompress, NULL) != 0) {
+        fprintf(stderr, "zword_count: cannot start the decompression thread\n");
+        return 1;
+    }
+    metrics = metrics_open("zword_count", 1, histogram ? NULL : labels);
+
+    // Count each decompressed block where it lies, publish progress, then hand it back
+    counts.state = OUT;
+    for (;;) {
+        struct block *b = queue_pop(&full_blocks);
+        if (b->len == 0) {
+            break;
+        }
+        count_block(&counts, b->data, b->len, histogram);
+        metrics_publish(metrics, 0, counts.nc, (uint64_t[METRICS_COUNTERS]){counts.nl, counts.nw, 0});
+        b->release(b);
+    }
+    pthread_join(producer, NULL);
+    metrics_close(metrics);
+    if (failed) {
+        fprintf(stderr, "zword_count: %s: corrupt or truncated input\n", path ? path : "stdin");
+        return 1;
+    }
+
+    if (histogram) {
+        print_histogram(&counts);
+    } else {
+        printf("%llu %llu %llu\n", counts.nl, counts.nw, counts.nc);
+    }
+    return 0;
+}
+
+void queue_init(struct queue *q)
+{
+    q->head = q->count = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+}
+
+void queue_push(struct queue *q, struct block *b)
+{
+    // Wait for room, then append at the tail
+    pthread_mutex_lock(&q->lock);
+    while (q->count == NBLOCKS) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    q->items[(q->head + q->count) % NBLOCKS] = b;
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+void return_to_pool(struct block *b)
+{
+    queue_push(&free_blocks, b);
+}
+
+struct block *queue_pop(struct queue *q)
+{
+    struct block *b;
+
+    // Wait for an item, then take it from the head
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    b = q->items[q->head];
+    q->head = (q->head + 1) % NBLOCKS;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return b;
+}
+
+void *decompress(void *arg)
+{
+    unsigned char magic[4];
+    size_t n;
+    struct block *end;
+
+    (void)arg;
+
+    // Sniff the format from the first bytes, which are passed on to the chosen reader
+    n = fread(magic, 1, sizeof magic, input);
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        failed = !read_gzip(magic, n);
+    } else if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        failed = !read_zstd(magic, n);
+    } else {
+        failed = !read_plain(magic, n);
+    }
+
+    // An empty block tells the counter the stream is over
+    end = queue_pop(&free_blocks);
+    end->len = 0;
+    queue_push(&full_blocks, end);
+    return NULL;
+}
+
+int read_plain(unsigned char *pending, size_t npending)
+{
+    struct block *b = queue_pop(&free_blocks);
+
+    // Uncompressed input is read straight into the blocks
+    memcpy(b->data, pending, npending);
+    b->len = npending + fread(b->data + npending, 1, BLOCKSIZE - npending, input);
+    while (b->len > 0) {
+        queue_push(&full_blocks, b);
+        b = queue_pop(&free_blocks);
+        b->len = fread(b->data, 1, BLOCKSIZE, input);
+    }
+    queue_push(&free_blocks, b);
+    return !ferror(input);
+}
+
+int read_gzip(unsigned char *pending, size_t npending)
+{
+    static unsigned char in[READSIZE];
+    z_stream zs;
+    struct block *b;
+    int ret = Z_OK;
+
+    memset(&zs, 0, sizeof zs);
+    if (inflateInit2(&zs, 15 + 32) != Z_OK) {     // 15 + 32: zlib or gzip header, detected
+        return 0;
+    }
+    memcpy(in, pending, npending);
+    zs.next_in = in;
+    zs.avail_in = (uInt)(npending + fread(in + npending, 1, READSIZE - npending, input));
+    b = queue_pop(&free_blocks);
+    zs.next_out = (Bytef *)b->data;
+    zs.avail_out = BLOCKSIZE;
+
+    // Inflate directly into pool blocks, shipping each one as soon as it is full
+    for (;;) {
+        if (zs.avail_in == 0) {
+            zs.next_in = in;
+            zs.avail_in = (uInt)fread(in, 1, READSIZE, input);
+            if (zs.avail_in == 0) {
+                break;
+            }
+        }
+        ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            break;
+        }
+        if (zs.avail_out == 0) {
+            b->len = BLOCKSIZE;
+            queue_push(&full_blocks, b);
+            b = queue_pop(&free_blocks);
+            zs.next_out = (Bytef *)b->data;
+            zs.avail_out = BLOCKSIZE;
+        }
+        // Concatenated gzip members (as written by "gzip -c a >> log.gz") continue the stream
+        if (ret == Z_STREAM_END) {
+            if (zs.avail_in == 0) {
+                zs.next_in = in;
+                zs.avail_in = (uInt)fread(in, 1, READSIZE, input);
+            }
+            if (zs.avail_in == 0) {
+                break;
+            }
+            inflateReset(&zs);
+        }
+    }
+
+    // Ship the partly filled last block
+    b->len = BLOCKSIZE - zs.avail_out;
+    if (b->len > 0) {
+        queue_push(&full_blocks, b);
+    } else {
+        queue_push(&free_blocks, b);
+    }
+    inflateEnd(&zs);
+    return ret == Z_STREAM_END && !ferror(input);
+}
+
+#ifdef WITH_ZSTD
+static int zinput_more(struct zinput *zi)
+{
+    size_t got;
+
+    // Keep the unread bytes, growing the buffer when a frame does not fit yet
+    memmove(zi->buf, zi->buf + zi->pos, zi->len - zi->pos);
+    zi->len -= zi->pos;
+    zi->pos = 0;
+    if (zi->len == zi->cap) {
+        unsigned char *grown = realloc(zi->buf, zi->cap * 2);
+        if (grown == NULL) {
+            return 0;
+        }
+        zi->buf = grown;
+        zi->cap *= 2;
+    }
+    got = fread(zi->buf + zi->len, 1, zi->cap - zi->len, input);
+    zi->len += got;
+    return got > 0;
+}
+
+static void *decode_frames(void *arg)
+{
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+
+    (void)arg;
+
+    // Take frames in input order, decode each in one call, and leave it for the reader to deliver
+    for (;;) {
+        struct frame *f;
+        size_t got;
+
+        pthread_mutex_lock(&frame_lock);
+        for (;;) {
+            f = &frames[next_decode % window];
+            if (decoders_quit || (f->state == FRAME_READY && f->seq == next_decode)) {
+                break;
+            }
+            pthread_cond_wait(&frame_ready, &frame_lock);
+        }
+        if (decoders_quit) {
+            pthread_mutex_unlock(&frame_lock);
+            break;
+        }
+        f->state = FRAME_BUSY;
+        next_decode++;
+        pthread_mutex_unlock(&frame_lock);
+
+        got = dctx != NULL ? ZSTD_decompressDCtx(dctx, f->out, f->out_len, f->src, f->src_len) : 0;
+        f->ok = dctx != NULL && !ZSTD_isError(got) && got == f->out_len;
+
+        pthread_mutex_lock(&frame_lock);
+        f->state = FRAME_DONE;
+        pthread_cond_broadcast(&frame_done);
+        pthread_mutex_unlock(&frame_lock);
+    }
+    ZSTD_freeDCtx(dctx);
+    return NULL;
+}
+
+// The counter is done with a frame's content, so its slot can take the next frame
+static void frame_counted(struct block *b)
+{
+    struct frame *f = (struct frame *)b;
+
+    pthread_mutex_lock(&frame_lock);
+    f->state = FRAME_FREE;
+    pthread_cond_broadcast(&frame_freed);
+    pthread_mutex_unlock(&frame_lock);
+}
+
+// Wait for frame seq to be decoded and queue its buffer to the counter as it is, with no copy
+static int deliver(long seq)
+{
+    struct frame *f = &frames[seq % window];
+    int queued;
+
+    pthread_mutex_lock(&frame_lock);
+    while (f->state != FRAME_DONE) {
+        pthread_cond_wait(&frame_done, &frame_lock);
+    }
+    queued = f->ok && f->out_len > 0;   // An empty block would end the stream
+    f->state = queued ? FRAME_QUEUED : FRAME_FREE;
+    pthread_mutex_unlock(&frame_lock);
+    if (queued) {
+        // Streamed bytes waiting in the current block come first
+        if (current->len > 0) {
+            queue_push(&full_blocks, current);
+            current = queue_pop(&free_blocks);
+            current->len = 0;
+        }
+        f->block = (struct block){f->out, f->out_len, frame_counted};
+        queue_push(&full_blocks, &f->block);
+    }
+    return f->ok;
+}
+
+// Decode one frame on this thread straight into pool blocks
+static int stream_frame(ZSTD_DCtx *dctx, struct zinput *zi)
+{
+    size_t ret = 1;
+
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+    while (ret != 0) {
+        if (zi->pos == zi->len) {
+            zinput_more(zi);
+        }
+        ZSTD_inBuffer zin = {zi->buf, zi->len, zi->pos};
+        ZSTD_outBuffer zout = {current->data, BLOCKSIZE, current->len};
+        ret = ZSTD_decompressStream(dctx, &zout, &zin);
+        if (ZSTD_isError(ret) || (ret != 0 && zin.pos == zi->pos && zout.pos == current->len)) {
+            return 0;           // Corrupt, or no progress because the input ended inside the frame
+        }
+        zi->pos = zin.pos;
+        current->len = zout.pos;
+        if (current->len == BLOCKSIZE) {
+            queue_push(&full_blocks, current);
+            current = queue_pop(&free_blocks);
+            current->len = 0;
+        }
+    }
+    return 1;
+}
+
+/*
+    Frames are independent, so a multi-frame file (zstd -T, pzstd, or logs appended with zstd -c >>)
+    is decoded by several threads: this thread cuts the input at frame boundaries and queues whole
+    frames, the decoders work on them at the same time, and each frame's buffer is passed to the
+    counter in input order. A slot takes a new frame only after the counter has handed it back.
+    A frame with no recorded size or one above FRAMEMAX is streamed here instead, after the frames
+    before it, so memory stays bounded by the window.
+*/
+int read_zstd(unsigned char *pending, size_t npending)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int ndecoders = ncpu > 1 ? (int)ncpu - 1 : 1, started = 0;
+    struct zinput zi = {malloc(READSIZE), 0, npending, READSIZE};
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    pthread_t tid[MAXDECODERS];
+    long seq_in = 0, seq_out = 0;
+    int ok = 1;
+
+    if (ndecoders > MAXDECODERS) {
+        ndecoders = MAXDECODERS;
+    }
+    window = ndecoders + 2;     // One frame per decoder, one being delivered, one being queued
+    frames = calloc((size_t)window, sizeof *frames);
+    if (zi.buf == NULL || dctx == NULL || frames == NULL) {
+        fprintf(stderr, "zword_count: out of memory\n");
+        return 0;
+    }
+    memcpy(zi.buf, pending, npending);
+    for (int t = 0; t < ndecoders; t++) {
+        if (pthread_create(&tid[started], NULL, decode_frames, NULL) == 0) {
+            started++;
+        }
+    }
+    current = queue_pop(&free_blocks);
+    current->len = 0;
+
+    while (ok) {
+        unsigned long long size;
+        size_t fsize;
+        struct frame *f;
+
+        // Stop cleanly only between frames; the header is at most FRAMEHEADER_MAX bytes
+        if (zi.pos == zi.len && !zinput_more(&zi)) {
+            break;
+        }
+        while (zi.len - zi.pos < FRAMEHEADER_MAX && zinput_more(&zi)) {
+        }
+        size = ZSTD_getFrameContentSize(zi.buf + zi.pos, zi.len - zi.pos);
+        if (started == 0 || size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR || size > FRAMEMAX) {
+            while (ok && seq_out < seq_in) {
+                ok = deliver(seq_out++);
+            }
+            ok = ok && stream_frame(dctx, &zi);
+            continue;
+        }
+
+        // Buffer the whole frame, wait for its slot to be delivered, and queue it for a decoder
+        while (ZSTD_isError(fsize = ZSTD_findFrameCompressedSize(zi.buf + zi.pos, zi.len - zi.pos))) {
+            if (!zinput_more(&zi)) {
+                ok = 0;
+                break;
+            }
+        }
+        if (ok && seq_in - seq_out == window) {
+            ok = deliver(seq_out++);
+        }
+        if (!ok) {
+            break;
+        }
+        f = &frames[seq_in % window];
+        pthread_mutex_lock(&frame_lock);
+        while (f->state != FRAME_FREE) {
+            pthread_cond_wait(&frame_freed, &frame_lock);
+        }
+        pthread_mutex_unlock(&frame_lock);
+        if (f->src_cap < fsize || f->out_cap < size) {
+            free(f->src);
+            free(f->out);
+            f->src = malloc(fsize);
+            f->out = malloc(size > 0 ? (size_t)size : 1);
+            f->src_cap = f->src != NULL ? fsize : 0;
+            f->out_cap = f->out != NULL ? (size_t)size : 0;
+            if (f->src == NULL || f->out == NULL) {
+                fprintf(stderr, "zword_count: out of memory\n");
+                ok = 0;
+                break;
+            }
+        }
+        memcpy(f->src, zi.buf + zi.pos, fsize);
+        f->src_len = fsize;
+        f->out_len = (size_t)size;
+        zi.pos += fsize;
+        pthread_mutex_lock(&frame_lock);
+        f->seq = seq_in++;
+        f->state = FRAME_READY;
+        pthread_cond_broadcast(&frame_ready);
+        pthread_mutex_unlock(&frame_lock);
+    }
+    while (ok && seq_out < seq_in) {
+        ok = deliver(seq_out++);
+    }
+
+    // Stop the decoders, then ship the partly filled last block
+    pthread_mutex_lock(&frame_lock);
+    decoders_quit = 1;
+    pthread_cond_broadcast(&frame_ready);
+    pthread_mutex_unlock(&frame_lock);
+    for (int t = 0; t < started; t++) {
+        pthread_join(tid[t], NULL);
+    }
+    if (current->len > 0) {
+        queue_push(&full_blocks, current);
+    } else {
+        queue_push(&free_blocks, current);
+    }
+
+    // Frame buffers still queued are freed only after the counter hands them back
+    pthread_mutex_lock(&frame_lock);
+    for (int i = 0; i < window; i++) {
+        while (frames[i].state == FRAME_QUEUED) {
+            pthread_cond_wait(&frame_freed, &frame_lock);
+        }
+    }
+    pthread_mutex_unlock(&frame_lock);
+    for (int i = 0; i < window; i++) {
+        free(frames[i].src);
+        free(frames[i].out);
+    }
+    free(frames);
+    free(zi.buf);
+    ZSTD_freeDCtx(dctx);
+    return ok && !ferror(input);
+}
+#else
+int read_zstd(unsigned char *pending, size_t npending)
+{
+    (void)pending;
+    (void)npending;
+    fprintf(stderr, "zword_count: zstd input needs a build with -DWITH_ZSTD -lzstd\n");
+    return 0;
+}
+#endif
+
+void count_block(struct counts *c, const char *s, size_t n, int histogram)
+{
+    // Character histogram: one increment per byte
+    if (histogram) {
+        for (size_t i = 0; i < n; i++) {
+            c->freq[(unsigned char)s[i]]++;
+        }
+        c->nc += n;
+        return;
+    }
+
+    // Same rules as word_count.c; state carries across block boundaries
+    int state = c->state;
+    unsigned long long nl = 0, nw = 0;
+    for (size_t i = 0; i < n; i++) {
+        char ch = s[i];
+        if (ch == '\n') {
+            ++nl;
+        }
+        if (ch == ' ' || ch == '\n' || ch == '\t') {
+            state = OUT;
+        }
+        else if (state == OUT) {
+            state = IN;
+            ++nw;
+        }
+    }
+    c->state = state;
+    c->nl += nl;
+    c->nw += nw;
+    c->nc += n;
+}
+
+void print_histogram(const struct counts *c)
+{
+    unsigned long long max = 0;
+
+    // Scale bars to the most frequent printable character
+    for (int i = ASCII_OFFSET; i < 127; i++) {
+        if (c->freq[i] > max) {
+            max = c->freq[i];
+        }
+    }
+
+    printf("Character frequency histogram:\n");
+    for (int i = ASCII_OFFSET; i < 127; i++) {
+        // Skip characters with zero frequency
+        if (c->freq[i] == 0) { continue; }
+        int bar = (int)(c->freq[i] * 50 / max);
+        printf("%c: %12llu ", i, c->freq[i]);
+        for (int j = 0; j < (bar > 0 ? bar : 1); j++) { putchar('|'); }
+        printf("\n");
+    }
+}
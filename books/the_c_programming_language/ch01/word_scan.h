@@ -0,0 +1,221 @@
+/*
+    Header: Word Scanning
+    Context: The C Programming Language, Chapter 1 - shared by the word and line tools built on word_count.c
+    Description: The byte hash and the word scanners used by word_freq.c, distinct_words.c and
+                 line_store.c, kept in one place so the word rules and the hash only change once.
+                 Words are separated by blanks, tabs and newlines (word_count.c). With punct set,
+                 '.', ';' and ':' also end a word and begin the next one (echo_input.c).
+                 Each word is handed to a callback; returning 0 from it stops the scan. Callbacks
+                 report their own errors.
+    Author: Greg Tate
+    Date: 2026-10-19
+*/
+
+#ifndef WORD_SCAN_H
+#define WORD_SCAN_H
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SCAN_MAXTHREADS 64
+#define SCAN_BLOCKSIZE (1 << 20)
+
+typedef int (*word_fn)(void *ctx, const char *word, size_t len);
+
+struct scan_job {
+    const char *data;
+    size_t lo, hi, size;
+    int punct;
+    word_fn add;
+    void *ctx;
+    int ok;
+};
+
+static inline uint64_t hash_bytes(const char *s, size_t n)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+    uint64_t k;
+
+    // Mix eight bytes at a time, then the tail
+    while (n >= 8) {
+        memcpy(&k, s, 8);
+        h = (h ^ k) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+        s += 8;
+        n -= 8;
+    }
+    k = 0;
+    memcpy(&k, s, n);
+    h = (h ^ k) * 0xC4CEB9FE1A85EC53ull;
+    return h ^ (h >> 29);
+}
+
+static inline int is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+static inline int is_punct(char c)
+{
+    return c == '.' || c == ';' || c == ':';
+}
+
+// True when position i of s continues a word that started before it
+static inline int inside_word(const char *s, size_t i, int punct)
+{
+    return i > 0 && !is_blank(s[i - 1]) && !is_blank(s[i]) && !(punct && is_punct(s[i]));
+}
+
+// Hand every word in s[0..n) to add; returns 0 if add stopped the scan
+static inline int scan_words(const char *s, size_t n, int punct, word_fn add, void *ctx)
+{
+    size_t i = 0;
+
+    while (i < n) {
+        while (i < n && is_blank(s[i])) {
+            i++;
+        }
+        if (i == n) {
+            break;
+        }
+        size_t start = i++;
+        while (i < n && !is_blank(s[i]) && !(punct && is_punct(s[i]))) {
+            i++;
+        }
+        if (!add(ctx, s + start, i - start)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static inline void *scan_chunk(void *arg)
+{
+    struct scan_job *job = arg;
+    size_t lo = job->lo, hi = job->hi;
+
+    // A word straddling the start belongs to the previous chunk; finish the last word past the end
+    while (lo < job->size && inside_word(job->data, lo, job->punct)) {
+        lo++;
+    }
+    while (hi < job->size && inside_word(job->data, hi, job->punct)) {
+        hi++;
+    }
+    job->ok = lo >= hi || scan_words(job->data + lo, hi - lo, job->punct, job->add, job->ctx);
+    return NULL;
+}
+
+// Scan a stream a buffer at a time, carrying a word cut off at the end of the buffer forward
+static inline int scan_stream(FILE *fp, int punct, word_fn add, void *ctx)
+{
+    size_t cap = 2 * SCAN_BLOCKSIZE, len = 0, got;
+    char *buf = malloc(cap);
+    int ok = 1;
+
+    if (buf == NULL) {
+        perror("scan_stream");
+        return 0;
+    }
+    while (ok && (got = fread(buf + len, 1, cap - len, fp)) > 0) {
+        size_t cut;
+        len += got;
+        for (cut = len; cut > 0 && !is_blank(buf[cut - 1]); cut--) {
+        }
+        if (cut == 0 && len == cap) {
+            char *grown = realloc(buf, cap * 2);  // A single word longer than the buffer
+            if (grown == NULL) {
+                perror("scan_stream");
+                free(buf);
+                return 0;
+            }
+            buf = grown;
+            cap *= 2;
+            continue;
+        }
+        ok = scan_words(buf, cut, punct, add, ctx);
+        memmove(buf, buf + cut, len - cut);
+        len -= cut;
+    }
+    ok = ok && scan_words(buf, len, punct, add, ctx);
+    free(buf);
+    if (ferror(fp)) {
+        perror("scan_stream");
+        return 0;
+    }
+    return ok;
+}
+
+/*
+    Scan a file on up to nthreads threads, thread t feeding ctx[t]. Returns how many contexts were
+    used (the caller merges ctx[1..] into ctx[0]), or -1 on error. A chunk whose thread cannot be
+    started is scanned on the calling thread. Pipes, FIFOs, files that report size 0 (as /proc
+    files do) and anything else that cannot be mapped are read as a stream into ctx[0].
+*/
+static inline int scan_file(const char *path, int nthreads, int punct, word_fn add, void *ctx[])
+{
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    pthread_t tid[SCAN_MAXTHREADS];
+    int started[SCAN_MAXTHREADS];
+    struct scan_job jobs[SCAN_MAXTHREADS];
+    char *data;
+    size_t size;
+    int ok = 1;
+
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    size = (size_t)st.st_size;
+    data = S_ISREG(st.st_mode) && size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if (data == MAP_FAILED) {
+        FILE *fp = fdopen(fd, "rb");
+        if (fp == NULL) {
+            perror(path);
+            close(fd);
+            return -1;
+        }
+        ok = scan_stream(fp, punct, add, ctx[0]);
+        fclose(fp);
+        return ok ? 1 : -1;
+    }
+    close(fd);
+
+    // Equal shares of the file, one per thread
+    if (size < SCAN_BLOCKSIZE || nthreads < 1) {
+        nthreads = 1;
+    }
+    if (nthreads > SCAN_MAXTHREADS) {
+        nthreads = SCAN_MAXTHREADS;
+    }
+    for (int t = 0; t < nthreads; t++) {
+        jobs[t] = (struct scan_job){data, size * (size_t)t / (size_t)nthreads,
+                                    size * (size_t)(t + 1) / (size_t)nthreads, size, punct, add, ctx[t], 0};
+        started[t] = pthread_create(&tid[t], NULL, scan_chunk, &jobs[t]) == 0;
+        if (!started[t]) {
+            scan_chunk(&jobs[t]);
+        }
+    }
+    for (int t = 0; t < nthreads; t++) {
+        if (started[t]) {
+            pthread_join(tid[t], NULL);
+        }
+        ok &= jobs[t].ok;
+    }
+    munmap(data, size);
+    return ok ? nthreads : -1;
+}
+
+#endif